@@ -123,9 +123,13 @@ public:
         std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
  
         if (xmlState.get() != nullptr)
+        {
             if (xmlState->hasTagName ("ParamTutorial"))
+            {
                 *gain = (float) xmlState->getDoubleAttribute ("gain", 1.0);
                 *invertPhase = xmlState->getBoolAttribute ("invertPhase", false); // [5]
+            }
+        }
     }
 
 private:
@@ -37,8 +37,9 @@
 
  type:             AudioProcessor
  mainClass:        TutorialProcessor
+ pluginCharacteristics: pluginWantsMidiIn
 
- useLocalCopy:     1
+ useLocalCopy:     0
 
  END_JUCE_PIP_METADATA
 
@@ -47,6 +48,25 @@
 
 #pragma once
 
+#include "../../Shared/ProcessProfiler.h"
+#include "../../Shared/ControllerAutomation.h"
+#include "../../Shared/ParameterTable.h"
+
+//==============================================================================
+/** Every parameter of TutorialProcessor, declared once. The processor creates,
+    reads, saves and restores them all from this table.
+*/
+struct TutorialParameters
+{
+    enum Index { gain, invertPhase };
+
+    static constexpr std::array<ParameterDescriptor, 2> descriptors
+    {{
+        { "gain",        "Gain",         ParameterDescriptor::floatType, 0.0f, 1.0f, 0.5f },
+        { "invertPhase", "Invert Phase", ParameterDescriptor::boolType,  0.0f, 1.0f, 0.0f }  // [3]
+    }};
+};
+
 //==============================================================================
 class TutorialProcessor  : public juce::AudioProcessor
 {
@@ -55,33 +75,61 @@ public:
     //==============================================================================
     TutorialProcessor()
     {
-        addParameter (gain        = new juce::AudioParameterFloat ("gain", "Gain", 0.0f, 1.0f, 0.5f));
-        addParameter (invertPhase = new juce::AudioParameterBool  ("invertPhase", "Invert Phase", false)); // [3]
+        parameters.addTo (*this);
+
+        controllers.mapController (7, 0);   // channel volume drives the gain
     }
 
     //==============================================================================
-    void prepareToPlay (double, int) override
+    /** How long the gain takes to reach a new setting, however the host
+        splits the audio into blocks. Takes effect from the next prepareToPlay().
+    */
+    void setGainRampLength (double milliseconds) noexcept        { gainRampMs = juce::jmax (0.0, milliseconds); }
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int) override
     {
-        auto phase = *invertPhase ? -1.0f : 1.0f;
-        previousGain = *gain * phase;
+        PROCESS_PROFILER_PREPARE (profiler, sampleRate);
+
+        auto phase = parameters.get<TutorialParameters::invertPhase>() ? -1.0f : 1.0f;
+        parameterGain = parameters.get<TutorialParameters::gain>();
+        controllerGain = -1.0f;
+
+        rampLength = juce::roundToInt (gainRampMs * 0.001 * sampleRate);
+        currentGain = targetGain = parameterGain * phase;
+        gainStep = 0.0f;
+        rampRemaining = 0;
     }
 
     void releaseResources() override {}
 
-    void processBlock (juce::AudioSampleBuffer& buffer, juce::MidiBuffer&) override
+    void processBlock (juce::AudioSampleBuffer& buffer, juce::MidiBuffer& midiMessages) override
     {
-        auto phase = *invertPhase ? -1.0f : 1.0f;  // [6]
-        auto currentGain = *gain * phase;          // [7]
+        PROCESS_PROFILE_BLOCK (profiler, buffer.getNumSamples());
 
-        if (juce::approximatelyEqual (currentGain, previousGain))
-        {
-            buffer.applyGain (currentGain);
-        }
-        else
+        auto phase = parameters.get<TutorialParameters::invertPhase>() ? -1.0f : 1.0f;  // [6]
+        auto newParameterGain = parameters.get<TutorialParameters::gain>();
+
+        // Moving the parameter takes the gain back from the controller. The
+        // controller doesn't move the parameter, as that would mean notifying
+        // the host from the audio thread.
+        if (! juce::approximatelyEqual (newParameterGain, parameterGain))
         {
-            buffer.applyGainRamp (0, buffer.getNumSamples(), previousGain, currentGain);
-            previousGain = currentGain;
+            parameterGain = newParameterGain;
+            controllerGain = -1.0f;
         }
+
+        // Each controller event starts a new ramp on exactly its own sample.
+        controllers.process (midiMessages, buffer.getNumSamples(),
+                             [this] (int, float value)
+                             {
+                                 controllerGain = parameters.getParameter<TutorialParameters::gain>()->convertFrom0to1 (value);
+                             },
+                             [this, &buffer, phase] (int start, int length)
+                             {
+                                 setTargetGain ((controllerGain >= 0.0f ? controllerGain : parameterGain) * phase);  // [7]
+                                 applyGain (buffer, start, length);
+                             });
     }
 
     //==============================================================================
@@ -90,7 +138,7 @@ public:
 
     //==============================================================================
     const juce::String getName() const override                  { return "Param Tutorial"; }
-    bool acceptsMidi() const override                            { return false; }
+    bool acceptsMidi() const override                            { return true; }
     bool producesMidi() const override                           { return false; }
     double getTailLengthSeconds() const override                 { return 0; }
 
@@ -101,35 +149,113 @@ public:
     const juce::String getProgramName (int) override             { return {}; }
     void changeProgramName (int, const juce::String&) override   {}
 
+   #if PROCESS_PROFILER_ENABLED
+    //==============================================================================
+    ProcessProfiler& getProfiler() noexcept                      { return profiler; }
+   #endif
+
     //==============================================================================
     void getStateInformation (juce::MemoryBlock& destData) override
     {
-        std::unique_ptr<juce::XmlElement> xml (new juce::XmlElement ("ParamTutorial"));
-        xml->setAttribute ("gain", (double) *gain);
-        xml->setAttribute ("invertPhase", *invertPhase); // [4]
-        copyXmlToBinary (*xml, destData);
+        parameters.writeState (destData); // [4]
     }
 
     void setStateInformation (const void* data, int sizeInBytes) override
     {
+        if (parameters.readState (data, sizeInBytes)) // [5]
+            return;
+
+        // Sessions saved before the state was binary hold it as XML.
         std::unique_ptr<juce::XmlElement> xmlState (getXmlFromBinary (data, sizeInBytes));
 
-        if (xmlState.get() != nullptr)
+        if (xmlState.get() != nullptr && xmlState->hasTagName ("ParamTutorial"))
+            parameters.readXml (*xmlState);
+    }
+
+private:
+    //==============================================================================
+    /** Like juce::SmoothedValue::setTargetValue(): a new target starts a ramp
+        from wherever the gain is now, which runs on across blocks until it
+        gets there. The phase is the gain's sign, so inverting it ramps the
+        gain through 0 rather than clicking.
+    */
+    void setTargetGain (float newTarget) noexcept
+    {
+        if (juce::approximatelyEqual (newTarget, targetGain))
+            return;
+
+        targetGain = newTarget;
+
+        if (rampLength <= 0)
         {
-            if (xmlState->hasTagName ("ParamTutorial"))
+            currentGain = targetGain;
+            rampRemaining = 0;
+            return;
+        }
+
+        gainStep = (targetGain - currentGain) / (float) rampLength;
+        rampRemaining = rampLength;
+    }
+
+    /** Applies the gain, phase and any ramp in progress to every channel in a
+        single pass, reading and writing each sample once. The ramp's gain is
+        worked out from its start for each sample rather than accumulated, so
+        the inner loop has no dependency from one sample to the next and the
+        compiler vectorises it, and the gain doesn't drift on a long ramp.
+    */
+    void applyGain (juce::AudioSampleBuffer& buffer, int start, int length) noexcept
+    {
+        auto numChannels = buffer.getNumChannels();
+        auto* const* channels = buffer.getArrayOfWritePointers();
+        auto numRamped = juce::jmin (length, rampRemaining);
+
+        if (numRamped > 0)
+        {
+            auto from = currentGain, step = gainStep;
+
+            for (int ch = 0; ch < numChannels; ++ch)
             {
-                *gain = (float) xmlState->getDoubleAttribute ("gain", 1.0);
-                *invertPhase = xmlState->getBoolAttribute ("invertPhase", false); // [5]
+                auto* samples = channels[ch] + start;
+
+                for (int i = 0; i < numRamped; ++i)
+                    samples[i] *= from + step * (float) i;
             }
+
+            rampRemaining -= numRamped;
+            currentGain = rampRemaining > 0 ? from + step * (float) numRamped : targetGain;
+        }
+
+        auto numSteady = length - numRamped;
+
+        if (numSteady <= 0 || currentGain == 1.0f)
+            return;
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* samples = channels[ch] + start + numRamped;
+
+            if (currentGain == 0.0f)
+                juce::FloatVectorOperations::clear (samples, numSteady);
+            else
+                juce::FloatVectorOperations::multiply (samples, currentGain, numSteady);
         }
     }
 
-private:
     //==============================================================================
-    juce::AudioParameterFloat* gain;
-    juce::AudioParameterBool* invertPhase; // [2]
+    ParameterSet<TutorialParameters> parameters; // [2]
+
+    // The gain as it's applied, with the phase as its sign, and the ramp
+    // towards the latest setting.
+    float currentGain = 0.0f, targetGain = 0.0f, gainStep = 0.0f;
+    int rampRemaining = 0, rampLength = 0;
+    double gainRampMs = 20.0;
+
+    // The gain parameter as of the last block, and the gain a controller has
+    // set since, or -1 if it hasn't.
+    float parameterGain = 0.0f, controllerGain = -1.0f;
+    ControllerAutomation controllers;
 
-    float previousGain;
+    PROCESS_PROFILER_MEMBER (profiler, { "processBlock" })
 
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (TutorialProcessor)
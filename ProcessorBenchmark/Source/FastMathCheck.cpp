@@ -0,0 +1,174 @@
+/*
+  ==============================================================================
+
+    FastMathCheck.cpp
+
+  ==============================================================================
+*/
+
+#include "FastMathCheck.h"
+#include "../../Shared/FastMath.h"
+
+//==============================================================================
+namespace
+{
+    /** The domain a function is checked over and the bounds documented in FastMath.h. */
+    struct Domain
+    {
+        const char* name;
+        double start, end;
+        bool relative;
+        double doubleBound, floatBound;
+    };
+
+    template <typename T, typename Function>
+    double measureError (const Domain& domain, Function&& fast, long double (*reference) (long double), int numPoints) noexcept
+    {
+        auto worst = 0.0;
+
+        for (int i = 0; i <= numPoints; ++i)
+        {
+            auto x = (T) (domain.start + (domain.end - domain.start) * i / numPoints);
+            auto expected = reference ((long double) x);
+            auto error = std::abs ((long double) fast (x) - expected);
+
+            if (domain.relative)
+                error /= std::abs (expected);
+
+            worst = juce::jmax (worst, (double) error);
+        }
+
+        return worst;
+    }
+
+    /** The fastest of a few runs over a buffer of arguments, in nanoseconds
+        per value. The function is inlined into the loop, so this times the
+        loop as the compiler vectorises it.
+    */
+    template <typename T, typename Function>
+    double timeFunction (Function&& function, const std::vector<T>& arguments, std::vector<T>& results)
+    {
+        auto numValues = results.size();
+        auto best = std::numeric_limits<double>::max();
+
+        for (int run = 0; run < 5; ++run)
+        {
+            auto startTicks = juce::Time::getHighResolutionTicks();
+
+            // Each repeat starts at a different argument, and the fence makes
+            // every repeat's results count, so none of the work can be skipped.
+            for (size_t repeat = 0; repeat < 64; ++repeat)
+            {
+                auto* input = arguments.data() + repeat;
+                auto* output = results.data();
+
+                for (size_t i = 0; i < numValues; ++i)
+                    output[i] = function (input[i]);
+
+                std::atomic_signal_fence (std::memory_order_seq_cst);
+            }
+
+            auto ns = juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks) * 1.0e9;
+            best = juce::jmin (best, ns / (64.0 * (double) numValues));
+        }
+
+        return best;
+    }
+
+    template <typename T, typename Fast, typename Std>
+    bool runCase (const Domain& domain, Fast&& fast, Std&& standard, long double (*reference) (long double), int numPoints)
+    {
+        auto error = measureError<T> (domain, fast, reference, numPoints);
+        auto bound = std::is_same_v<T, float> ? domain.floatBound : domain.doubleBound;
+
+        // The arguments are spread over the domain in a shuffled order, so
+        // the timings include nothing that a sorted input would make cheap.
+        std::vector<T> results (4096), arguments (results.size() + 64);
+        juce::Random random (0x5eed);
+
+        for (auto& x : arguments)
+            x = (T) (domain.start + (domain.end - domain.start) * random.nextDouble());
+
+        auto fastNs = timeFunction (fast, arguments, results);
+        auto stdNs  = timeFunction (standard, arguments, results);
+        auto passed = error <= bound;
+
+        std::cout << juce::String (domain.name).paddedRight (' ', 16)
+                  << (std::is_same_v<T, float> ? "f32" : "f64")
+                  << "  " << (domain.relative ? "rel" : "abs") << " error " << juce::String (error, 3, true).paddedRight (' ', 10)
+                  << " bound " << juce::String (bound, 3, true).paddedRight (' ', 10)
+                  << juce::String (fastNs, 2).paddedLeft (' ', 7) << " ns  (std "
+                  << juce::String (stdNs, 2) << " ns, " << juce::String (stdNs / fastNs, 1) << "x)  "
+                  << (passed ? "ok" : "FAILED") << std::endl;
+
+        return passed;
+    }
+
+    /** Checks a function in both precisions, and returns how many failed.
+        fast and standard are generic lambdas, so each precision gets its own
+        inlined copy.
+    */
+    template <typename Fast, typename Std>
+    int check (const Domain& domain, Fast&& fast, Std&& standard, long double (*reference) (long double), int numPoints)
+    {
+        return (runCase<float>  (domain, fast, standard, reference, numPoints) ? 0 : 1)
+             + (runCase<double> (domain, fast, standard, reference, numPoints) ? 0 : 1);
+    }
+}
+
+//==============================================================================
+void runFastMathCheck (const juce::ArgumentList& args)
+{
+    auto n = args.containsOption ("--quick") ? 100000 : 2000000;
+    auto failed = 0;
+
+    failed += check ({ "tan", -1.5393804, 1.5393804, true, 1.4e-8, 3.0e-6 },
+                     [] (auto x) { return FastMath::tan (x); },
+                     [] (auto x) { return std::tan (x); },
+                     [] (long double x) { return std::tan (x); }, n);
+
+    failed += check ({ "exp2", -100.0, 100.0, true, 4.0e-16, 3.0e-7 },
+                     [] (auto x) { return FastMath::exp2 (x); },
+                     [] (auto x) { return std::exp2 (x); },
+                     [] (long double x) { return std::exp2 (x); }, n);
+
+    failed += check ({ "exp", -20.0, 20.0, true, 2.0e-15, 1.5e-6 },
+                     [] (auto x) { return FastMath::exp (x); },
+                     [] (auto x) { return std::exp (x); },
+                     [] (long double x) { return std::exp (x); }, n);
+
+    failed += check ({ "pow10", -6.0, 6.0, true, 3.0e-15, 1.5e-6 },
+                     [] (auto x) { return FastMath::pow10 (x); },
+                     [] (auto x) { return std::pow (decltype (x) (10), x); },
+                     [] (long double x) { return std::pow (10.0L, x); }, n);
+
+    failed += check ({ "decibelsToGain", -99.0, 60.0, true, 2.0e-15, 1.0e-6 },
+                     [] (auto x) { return FastMath::decibelsToGain (x); },
+                     [] (auto x) { return juce::Decibels::decibelsToGain (x); },
+                     [] (long double x) { return std::pow (10.0L, x / 20); }, n);
+
+    failed += check ({ "log2", 1.0e-6, 1000.0, false, 2.0e-15, 1.0e-6 },
+                     [] (auto x) { return FastMath::log2 (x); },
+                     [] (auto x) { return std::log2 (x); },
+                     [] (long double x) { return std::log2 (x); }, n);
+
+    failed += check ({ "gainToDecibels", 1.0e-5, 100.0, false, 1.5e-14, 6.0e-6 },
+                     [] (auto x) { return FastMath::gainToDecibels (x); },
+                     [] (auto x) { return juce::Decibels::gainToDecibels (x); },
+                     [] (long double x) { return 20 * std::log10 (x); }, n);
+
+    failed += check ({ "sin", -8192.0, 8192.0, false, 2.5e-16, 1.5e-7 },
+                     [] (auto x) { return FastMath::sin (x); },
+                     [] (auto x) { return std::sin (x); },
+                     [] (long double x) { return std::sin (x); }, n);
+
+    failed += check ({ "cos", -8192.0, 8192.0, false, 2.5e-16, 1.5e-7 },
+                     [] (auto x) { return FastMath::cos (x); },
+                     [] (auto x) { return std::cos (x); },
+                     [] (long double x) { return std::cos (x); }, n);
+
+    if (failed > 0)
+        juce::ConsoleApplication::fail (juce::String (failed) + " functions outside their documented error bounds");
+
+    std::cout << "Every function is within its documented error bound" << std::endl;
+}
@@ -0,0 +1,19 @@
+/*
+  ==============================================================================
+
+    FastMathCheck.h
+    Checks the error bounds of Shared/FastMath.h and times it.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+/** The --fast-math command: measures the largest error of every FastMath
+    function, in float and double, against the std:: function evaluated in
+    long double, and fails if any is outside its documented bound. Then
+    times each over a buffer of arguments against its std:: equivalent.
+*/
+void runFastMathCheck (const juce::ArgumentList& args);
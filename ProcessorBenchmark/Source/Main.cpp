@@ -0,0 +1,464 @@
+/*
+  ==============================================================================
+
+    processBlock micro-benchmarks.
+
+    Drives SimpleEQAudioProcessor (at each oversampling factor), a
+    juce::dsp::ProcessorChain version of the same filters and the
+    AudioParameterTutorial TutorialProcessor across a
+    matrix of sample rates, block sizes, channel
+    counts, parameter-modulation rates and (where the processor supports it)
+    sample precision, and reports the cost per sample and
+    the worst block. Results can be written as JSON so that runs from different
+    commits can be compared. Each processor's results end with how far its
+    cost per sample moves with the host's block size.
+
+    --rt-check runs the same processors under a simulated host instead, and
+    fails if processBlock allocates or takes a lock (see RealtimeCheck.h).
+
+    --fast-math checks the error bounds of Shared/FastMath.h and times it
+    against the std:: functions (see FastMathCheck.h).
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../SimpleEQ/Source/PluginProcessor.h"
+#include "../../AudioParameterTutorial/Source/AudioParameterTutorial_04.h"
+#include "ProcessorChainBaseline.h"
+#include "RealtimeCheck.h"
+#include "FastMathCheck.h"
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+//==============================================================================
+/** Reads the CPU's time-stamp counter, or returns 0 where there isn't one. */
+static inline juce::uint64 readCycleCounter() noexcept
+{
+   #if JUCE_INTEL
+    return (juce::uint64) __rdtsc();
+   #else
+    return 0;
+   #endif
+}
+
+static constexpr bool hasCycleCounter()
+{
+   #if JUCE_INTEL
+    return true;
+   #else
+    return false;
+   #endif
+}
+
+//==============================================================================
+/** A processor to benchmark, the parameter its modulation sweeps, and any
+    parameter values (in their own units) to set before it starts.
+*/
+struct Subject
+{
+    juce::String name;
+    std::function<std::unique_ptr<juce::AudioProcessor>()> create;
+    juce::String modulatedParameter;
+    std::vector<std::pair<juce::String, float>> settings;
+};
+
+struct Config
+{
+    double sampleRate;
+    int blockSize, numChannels;
+    double modulationHz;
+    bool doublePrecision;
+};
+
+struct Result
+{
+    juce::String processor;
+    Config config;
+    bool supported = true;
+    juce::int64 numBlocks = 0;
+    double nsPerSample = 0.0, nsPerChannelSample = 0.0, cyclesPerSample = 0.0;
+    double worstBlockNs = 0.0, deadlineNs = 0.0;
+};
+
+//==============================================================================
+static juce::AudioProcessorParameter* findParameter (juce::AudioProcessor& processor, const juce::String& paramID)
+{
+    for (auto* p : processor.getParameters())
+        if (auto* withID = dynamic_cast<juce::AudioProcessorParameterWithID*> (p))
+            if (withID->paramID == paramID)
+                return p;
+
+    return nullptr;
+}
+
+static bool configure (juce::AudioProcessor& processor, const Config& config)
+{
+    auto channels = juce::AudioChannelSet::canonicalChannelSet (config.numChannels);
+
+    juce::AudioProcessor::BusesLayout layout;
+    layout.inputBuses.add (channels);
+    layout.outputBuses.add (channels);
+
+    if (! processor.setBusesLayout (layout))
+        return false;
+
+    processor.setProcessingPrecision (config.doublePrecision ? juce::AudioProcessor::doublePrecision
+                                                             : juce::AudioProcessor::singlePrecision);
+    processor.setRateAndBufferSizeDetails (config.sampleRate, config.blockSize);
+    processor.prepareToPlay (config.sampleRate, config.blockSize);
+    return true;
+}
+
+/** Runs one configuration for (at least) the given amount of audio. */
+template <typename SampleType>
+static Result runBenchmark (const Subject& subject, const Config& config,
+                            const juce::AudioBuffer<float>& noise, double secondsOfAudio)
+{
+    Result result;
+    result.processor = subject.name;
+    result.config = config;
+
+    auto processor = subject.create();
+
+    for (auto& [paramID, value] : subject.settings)
+    {
+        auto* parameter = dynamic_cast<juce::RangedAudioParameter*> (findParameter (*processor, paramID));
+        jassert (parameter != nullptr);
+
+        if (parameter != nullptr)
+            parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    if (! configure (*processor, config))
+    {
+        result.supported = false;
+        return result;
+    }
+
+    auto* modulated = config.modulationHz > 0.0 ? findParameter (*processor, subject.modulatedParameter) : nullptr;
+    jassert (config.modulationHz <= 0.0 || modulated != nullptr);
+
+    auto numBlocks = juce::jmax ((juce::int64) 200, (juce::int64) (secondsOfAudio * config.sampleRate / config.blockSize));
+    auto numWarmUpBlocks = juce::jmax ((juce::int64) 10, numBlocks / 10);
+
+    juce::AudioBuffer<SampleType> buffer (config.numChannels, config.blockSize);
+    juce::MidiBuffer midi;
+
+    juce::int64 totalTicks = 0, worstTicks = 0;
+    juce::uint64 totalCycles = 0;
+    int noisePos = 0;
+
+    for (juce::int64 block = 0; block < numWarmUpBlocks + numBlocks; ++block)
+    {
+        // Refill the input and move the parameter outside of the timed region.
+        for (int i = 0; i < config.blockSize; ++i)
+        {
+            for (int ch = 0; ch < config.numChannels; ++ch)
+                buffer.setSample (ch, i, (SampleType) noise.getSample (ch % noise.getNumChannels(), noisePos));
+
+            noisePos = (noisePos + 1) % noise.getNumSamples();
+        }
+
+        if (modulated != nullptr)
+        {
+            auto time = (double) (block * config.blockSize) / config.sampleRate;
+            modulated->setValueNotifyingHost ((float) (0.5 + 0.5 * std::sin (juce::MathConstants<double>::twoPi * config.modulationHz * time)));
+        }
+
+        auto startCycles = readCycleCounter();
+        auto startTicks = juce::Time::getHighResolutionTicks();
+
+        processor->processBlock (buffer, midi);
+
+        auto ticks = juce::Time::getHighResolutionTicks() - startTicks;
+        auto cycles = readCycleCounter() - startCycles;
+
+        if (block >= numWarmUpBlocks)
+        {
+            totalTicks += ticks;
+            totalCycles += cycles;
+            worstTicks = juce::jmax (worstTicks, ticks);
+        }
+    }
+
+    processor->releaseResources();
+
+    auto numSamples = (double) numBlocks * config.blockSize;
+    auto totalNs = juce::Time::highResolutionTicksToSeconds (totalTicks) * 1.0e9;
+
+    result.numBlocks = numBlocks;
+    result.nsPerSample = totalNs / numSamples;
+    result.nsPerChannelSample = result.nsPerSample / config.numChannels;
+    result.cyclesPerSample = hasCycleCounter() ? (double) totalCycles / numSamples
+                                               : result.nsPerSample * juce::SystemStats::getCpuSpeedInMegahertz() * 1.0e-3;
+    result.worstBlockNs = juce::Time::highResolutionTicksToSeconds (worstTicks) * 1.0e9;
+    result.deadlineNs = config.blockSize / config.sampleRate * 1.0e9;
+    return result;
+}
+
+//==============================================================================
+static juce::var toJSON (const Result& r)
+{
+    auto* o = new juce::DynamicObject();
+    o->setProperty ("processor",          r.processor);
+    o->setProperty ("sampleRate",         r.config.sampleRate);
+    o->setProperty ("blockSize",          r.config.blockSize);
+    o->setProperty ("channels",           r.config.numChannels);
+    o->setProperty ("modulationHz",       r.config.modulationHz);
+    o->setProperty ("precision",          r.config.doublePrecision ? "double" : "float");
+    o->setProperty ("supported",          r.supported);
+
+    if (r.supported)
+    {
+        o->setProperty ("blocks",             r.numBlocks);
+        o->setProperty ("nsPerSample",        r.nsPerSample);
+        o->setProperty ("nsPerChannelSample", r.nsPerChannelSample);
+        o->setProperty ("cyclesPerSample",    r.cyclesPerSample);
+        o->setProperty ("worstBlockNs",       r.worstBlockNs);
+        o->setProperty ("deadlineNs",         r.deadlineNs);
+        o->setProperty ("worstBlockLoad",     r.worstBlockNs / r.deadlineNs);
+    }
+
+    return juce::var (o);
+}
+
+static juce::String describe (const Result& r)
+{
+    auto config = r.processor.paddedRight (' ', 12)
+                + juce::String (r.config.sampleRate / 1000.0, 1).paddedLeft (' ', 6) + " kHz"
+                + juce::String (r.config.blockSize).paddedLeft (' ', 6) + " smp"
+                + juce::String (r.config.numChannels).paddedLeft (' ', 3) + " ch"
+                + juce::String (r.config.modulationHz, 0).paddedLeft (' ', 5) + " Hz mod"
+                + (r.config.doublePrecision ? "  f64" : "  f32");
+
+    if (! r.supported)
+        return config + "   (layout not supported)";
+
+    return config
+         + juce::String (r.nsPerSample, 2).paddedLeft (' ', 10) + " ns/smp"
+         + juce::String (r.cyclesPerSample, 1).paddedLeft (' ', 9) + " cyc/smp"
+         + juce::String (r.worstBlockNs / 1000.0, 2).paddedLeft (' ', 10) + " us worst ("
+         + juce::String (100.0 * r.worstBlockNs / r.deadlineNs, 2) + "% of deadline)";
+}
+
+/** For each configuration apart from the block size, the cost per sample at
+    the slowest block size over that at the fastest. A processor whose cost
+    doesn't depend on the host's block size comes out close to 1.
+*/
+static juce::String describeBlockSizeSpread (const std::vector<Result>& results)
+{
+    std::map<juce::String, std::pair<double, double>> ranges;
+
+    for (auto& r : results)
+    {
+        if (! r.supported)
+            continue;
+
+        auto key = juce::String (r.config.sampleRate / 1000.0, 1) + " kHz "
+                 + juce::String (r.config.numChannels) + " ch "
+                 + juce::String (r.config.modulationHz, 0) + " Hz mod"
+                 + (r.config.doublePrecision ? " f64" : " f32");
+
+        auto [it, inserted] = ranges.insert ({ key, { r.nsPerSample, r.nsPerSample } });
+
+        if (! inserted)
+            it->second = { juce::jmin (it->second.first, r.nsPerSample), juce::jmax (it->second.second, r.nsPerSample) };
+    }
+
+    if (ranges.empty())
+        return {};
+
+    auto worst = 0.0, total = 0.0;
+    juce::String worstKey;
+
+    for (auto& [key, range] : ranges)
+    {
+        auto spread = range.second / range.first;
+        total += spread;
+
+        if (spread > worst)
+        {
+            worst = spread;
+            worstKey = key;
+        }
+    }
+
+    return "  ns/smp slowest/fastest block size: mean " + juce::String (total / (double) ranges.size(), 2)
+         + "x, worst " + juce::String (worst, 2) + "x (" + worstKey + ")";
+}
+
+//==============================================================================
+static void runAll (const juce::ArgumentList& args)
+{
+    // All three bands switched on, so that the whole chain is measured.
+    std::vector<std::pair<juce::String, float>> eqSettings { { "LowCut Freq",  80.0f },    { "LowCut Slope",  1.0f },
+                                                             { "Peak Freq",    1000.0f },  { "Peak Gain",     6.0f },
+                                                             { "Peak Quality", 1.0f },
+                                                             { "HighCut Freq", 12000.0f }, { "HighCut Slope", 1.0f } };
+
+    auto subBlockSize = SimpleEQAudioProcessor::defaultSubBlockSize;
+
+    if (args.containsOption ("--sub-block"))
+        subBlockSize = juce::jmax (0, args.getValueForOption ("--sub-block").getIntValue());
+
+    auto createSimpleEQ = [subBlockSize]
+    {
+        auto processor = std::make_unique<SimpleEQAudioProcessor>();
+        processor->setSubBlockSize (subBlockSize);
+        return processor;
+    };
+
+    juce::Array<Subject> subjects;
+    subjects.add ({ "SimpleEQ", createSimpleEQ, "LowCut Freq", eqSettings });
+
+    // The same settings again at each oversampling factor, with the default filters.
+    for (int order = 1; order <= 3; ++order)
+    {
+        auto oversampledSettings = eqSettings;
+        oversampledSettings.push_back ({ "Oversampling", (float) order });
+
+        subjects.add ({ "SimpleEQ-" + juce::String (1 << order) + "x", createSimpleEQ, "LowCut Freq", oversampledSettings });
+    }
+
+    // The state-variable engine, whose cutoff glides sample by sample under the sweep.
+    auto svfSettings = eqSettings;
+    svfSettings.push_back ({ "Filter Engine", 1.0f });
+    subjects.add ({ "SimpleEQ-SVF", createSimpleEQ, "LowCut Freq", svfSettings });
+
+    subjects.add ({ "DspChain", [] { return std::make_unique<ProcessorChainBaseline>(); }, "LowCut Freq", eqSettings });
+    subjects.add ({ "Tutorial", [] { return std::make_unique<TutorialProcessor>(); },      "gain",        {} });
+
+    std::vector<double> sampleRates { 44100.0, 48000.0, 88200.0, 96000.0, 176400.0, 192000.0 };
+    std::vector<int> blockSizes { 1, 7, 32, 64, 127, 256, 511, 512, 1024, 4096, 8192 };
+    std::vector<int> channelCounts { 1, 2, 6, 12, 16 };   // mono, stereo, 5.1, 7.1.4, 3rd order ambisonics
+    std::vector<double> modulationRates { 0.0, 1.0, 20.0 };
+    auto secondsOfAudio = 2.0;
+
+    if (args.containsOption ("--quick"))
+    {
+        sampleRates = { 48000.0 };
+        blockSizes = { 1, 64, 511, 4096 };
+        modulationRates = { 0.0, 20.0 };
+        secondsOfAudio = 0.5;
+    }
+
+    if (args.containsOption ("--processor"))
+    {
+        auto wanted = args.getValueForOption ("--processor");
+        subjects.removeIf ([&] (const Subject& s) { return ! s.name.equalsIgnoreCase (wanted); });
+
+        if (subjects.isEmpty())
+            juce::ConsoleApplication::fail ("Unknown processor: " + wanted);
+    }
+
+    juce::Random random (0x5eed);
+    juce::AudioBuffer<float> noise (2, 1 << 16);
+
+    for (int ch = 0; ch < noise.getNumChannels(); ++ch)
+        for (int i = 0; i < noise.getNumSamples(); ++i)
+            noise.setSample (ch, i, 0.25f * (random.nextFloat() * 2.0f - 1.0f));
+
+    juce::Array<juce::var> results;
+
+    for (auto& subject : subjects)
+    {
+        std::vector<Result> subjectResults;
+        std::vector<bool> precisions { false };
+
+        if (! args.containsOption ("--float-only") && subject.create()->supportsDoublePrecisionProcessing())
+            precisions.push_back (true);
+
+        for (auto doublePrecision : precisions)
+            for (auto sampleRate : sampleRates)
+                for (auto blockSize : blockSizes)
+                    for (auto numChannels : channelCounts)
+                        for (auto modulationHz : modulationRates)
+                        {
+                            Config config { sampleRate, blockSize, numChannels, modulationHz, doublePrecision };
+
+                            auto result = doublePrecision ? runBenchmark<double> (subject, config, noise, secondsOfAudio)
+                                                          : runBenchmark<float>  (subject, config, noise, secondsOfAudio);
+                            std::cout << describe (result) << std::endl;
+                            results.add (toJSON (result));
+                            subjectResults.push_back (result);
+                        }
+
+        std::cout << subject.name << describeBlockSizeSpread (subjectResults) << std::endl;
+    }
+
+    if (args.containsOption ("--json"))
+    {
+        auto* root = new juce::DynamicObject();
+        root->setProperty ("benchmark", "ProcessorBenchmark");
+        root->setProperty ("formatVersion", 4);
+        root->setProperty ("label", args.getValueForOption ("--label"));
+        root->setProperty ("subBlockSize", subBlockSize);
+        root->setProperty ("time", juce::Time::getCurrentTime().toISO8601 (true));
+        root->setProperty ("cpu", juce::SystemStats::getCpuModel());
+        root->setProperty ("cpuMHz", juce::SystemStats::getCpuSpeedInMegahertz());
+        root->setProperty ("cycleCounter", hasCycleCounter() ? "tsc" : "estimated from clock speed");
+        root->setProperty ("results", results);
+
+        auto file = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--json"));
+
+        if (! file.replaceWithText (juce::JSON::toString (juce::var (root))))
+            juce::ConsoleApplication::fail ("Couldn't write " + file.getFullPathName());
+
+        std::cout << "Wrote " << file.getFullPathName() << std::endl;
+    }
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+
+    app.addHelpCommand ("--help|-h", "ProcessorBenchmark - processBlock micro-benchmarks", false);
+
+    app.addDefaultCommand ({ "",
+                             "[options]",
+                             "Benchmarks processBlock across sample rates, block sizes, channel counts, modulation rates and precisions",
+                             "Options:\n"
+                             "  --float-only        skip the double precision runs\n"
+                             "  --json=<file>       also write the results as JSON\n"
+                             "  --label=<text>      stored in the JSON, e.g. the commit being measured\n"
+                             "  --processor=<name>  only run SimpleEQ, SimpleEQ-2x, SimpleEQ-4x, SimpleEQ-8x,\n"
+                             "                      SimpleEQ-SVF, DspChain or Tutorial\n"
+                             "  --quick             a much smaller matrix, for a fast sanity check\n"
+                             "  --sub-block=<n>     the size of SimpleEQ's internal sub-blocks (default "
+                                 + juce::String (SimpleEQAudioProcessor::defaultSubBlockSize) + "),\n"
+                             "                      or 0 to process the host's blocks whole\n",
+                             runAll });
+
+    app.addCommand ({ "--rt-check",
+                      "--rt-check [--processor=<name>]",
+                      "Fails if processBlock allocates or locks",
+                      "Plays noise through SimpleEQ (in each of its processing modes) and every step of the\n"
+                      "AudioParameterTutorial on a simulated audio thread, at block sizes from 1 to 4096\n"
+                      "samples and with the host automating every parameter and sending MIDI controllers,\n"
+                      "and reports any allocation or lock taken inside processBlock with its stack trace.\n"
+                      "Options:\n"
+                      "  --processor=<name>  only check scenarios whose name starts with this\n",
+                      runRealtimeCheck });
+
+    app.addCommand ({ "--fast-math",
+                      "--fast-math [--quick]",
+                      "Checks the error bounds of FastMath and times it",
+                      "Measures the largest error of every FastMath function, in float and double, against\n"
+                      "the std:: function in long double over its documented domain, and fails if any is\n"
+                      "outside its bound. Then times each one against its std:: equivalent.\n"
+                      "Options:\n"
+                      "  --quick             check 100000 points per function rather than 2000000\n",
+                      runFastMathCheck });
+
+    return app.findAndRunCommand (argc, argv);
+}
@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    ProcessorChainBaseline.h
+    The SimpleEQ filter chain built from juce::dsp::ProcessorChain.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../SimpleEQ/Source/PluginProcessor.h"
+
+//==============================================================================
+/**
+    SimpleEQ's LowCut -> Peak -> HighCut chain written the straightforward way,
+    as a yardstick for the fused kernel: one juce::dsp::ProcessorChain per
+    channel, each band a separate pass over the block, and the coefficients
+    redesigned on the audio thread at the start of every block.
+
+    It uses SimpleEQ's parameter layout, so the same settings and modulation
+    can be applied to both.
+*/
+class ProcessorChainBaseline  : public juce::AudioProcessor
+{
+public:
+    //==============================================================================
+    ProcessorChainBaseline()
+        : AudioProcessor (BusesProperties().withInput  ("Input",  juce::AudioChannelSet::stereo(), true)
+                                           .withOutput ("Output", juce::AudioChannelSet::stereo(), true))
+    {
+    }
+
+    //==============================================================================
+    void prepareToPlay (double sampleRate, int samplesPerBlock) override
+    {
+        juce::dsp::ProcessSpec spec { sampleRate, (juce::uint32) samplesPerBlock, 1 };
+
+        chains.clear();
+
+        for (int ch = 0; ch < getTotalNumInputChannels(); ++ch)
+            chains.add (new MonoChain())->prepare (spec);
+    }
+
+    void releaseResources() override {}
+
+    bool isBusesLayoutSupported (const BusesLayout& layouts) const override
+    {
+        return ! layouts.getMainOutputChannelSet().isDisabled()
+            && layouts.getMainOutputChannelSet() == layouts.getMainInputChannelSet();
+    }
+
+    void processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override
+    {
+        juce::ScopedNoDenormals noDenormals;
+
+        updateFilters();
+
+        juce::dsp::AudioBlock<float> block (buffer);
+
+        for (int ch = 0; ch < chains.size(); ++ch)
+        {
+            auto channelBlock = block.getSingleChannelBlock ((size_t) ch);
+            chains[ch]->process (juce::dsp::ProcessContextReplacing<float> (channelBlock));
+        }
+    }
+
+    //==============================================================================
+    juce::AudioProcessorEditor* createEditor() override          { return nullptr; }
+    bool hasEditor() const override                              { return false; }
+
+    //==============================================================================
+    const juce::String getName() const override                  { return "ProcessorChain baseline"; }
+    bool acceptsMidi() const override                            { return false; }
+    bool producesMidi() const override                           { return false; }
+    double getTailLengthSeconds() const override                 { return 0.0; }
+
+    //==============================================================================
+    int getNumPrograms() override                                { return 1; }
+    int getCurrentProgram() override                             { return 0; }
+    void setCurrentProgram (int) override                        {}
+    const juce::String getProgramName (int) override             { return {}; }
+    void changeProgramName (int, const juce::String&) override   {}
+
+    //==============================================================================
+    void getStateInformation (juce::MemoryBlock&) override       {}
+    void setStateInformation (const void*, int) override         {}
+
+    juce::AudioProcessorValueTreeState apvts { *this, nullptr, "Parameters", SimpleEQAudioProcessor::createParameterLayout() };
+
+private:
+    //==============================================================================
+    using Filter    = juce::dsp::IIR::Filter<float>;
+    using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+    using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+    using CutCoefficients = juce::ReferenceCountedArray<juce::dsp::IIR::Coefficients<float>>;
+
+    enum ChainPositions
+    {
+        LowCut,
+        Peak,
+        HighCut
+    };
+
+    float getValue (const juce::String& paramID) const      { return apvts.getRawParameterValue (paramID)->load(); }
+
+    void updateFilters()
+    {
+        auto sampleRate = getSampleRate();
+        auto lowCutSlope  = (int) getValue ("LowCut Slope");
+        auto highCutSlope = (int) getValue ("HighCut Slope");
+
+        auto lowCut = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod (getValue ("LowCut Freq"), sampleRate,
+                                                                                                    2 * (lowCutSlope + 1));
+        auto highCut = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod (getValue ("HighCut Freq"), sampleRate,
+                                                                                                   2 * (highCutSlope + 1));
+        auto peak = juce::dsp::IIR::Coefficients<float>::makePeakFilter (sampleRate, getValue ("Peak Freq"), getValue ("Peak Quality"),
+                                                                         juce::Decibels::decibelsToGain (getValue ("Peak Gain")));
+
+        for (auto* chain : chains)
+        {
+            updateCutFilter (chain->get<LowCut>(), lowCut, lowCutSlope + 1);
+            chain->get<Peak>().coefficients = peak;
+            updateCutFilter (chain->get<HighCut>(), highCut, highCutSlope + 1);
+        }
+    }
+
+    static void updateCutFilter (CutFilter& cut, const CutCoefficients& coefficients, int numStages)
+    {
+        updateStage<0> (cut, coefficients, numStages);
+        updateStage<1> (cut, coefficients, numStages);
+        updateStage<2> (cut, coefficients, numStages);
+        updateStage<3> (cut, coefficients, numStages);
+    }
+
+    template <int Index>
+    static void updateStage (CutFilter& cut, const CutCoefficients& coefficients, int numStages)
+    {
+        auto used = Index < numStages;
+        cut.setBypassed<Index> (! used);
+
+        if (used)
+            cut.get<Index>().coefficients = coefficients[Index];
+    }
+
+    juce::OwnedArray<MonoChain> chains;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProcessorChainBaseline)
+};
@@ -0,0 +1,447 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.cpp
+
+  ==============================================================================
+*/
+
+#include "RealtimeCheck.h"
+#include "../../SimpleEQ/Source/PluginProcessor.h"
+#include "../../SimpleEQ/Source/SpectrumAnalyzer.h"
+#include "../../Shared/ParameterTable.h"
+
+// Every step of the tutorial defines a TutorialProcessor, so each gets a namespace of its own.
+namespace TutorialStep1 {
+ #include "../../AudioParameterTutorial/Source/AudioParameterTutorial_01.h"
+}
+namespace TutorialStep2 {
+ #include "../../AudioParameterTutorial/Source/AudioParameterTutorial_02.h"
+}
+namespace TutorialStep3 {
+ #include "../../AudioParameterTutorial/Source/AudioParameterTutorial_03.h"
+}
+namespace TutorialStep4 {
+ #include "../../AudioParameterTutorial/Source/AudioParameterTutorial_04.h"
+}
+
+#if JUCE_LINUX && defined (__GLIBC__)
+ #define REALTIME_CHECK_INTERPOSE_LIBC 1
+ #include <dlfcn.h>
+ #include <pthread.h>
+#else
+ #define REALTIME_CHECK_INTERPOSE_LIBC 0
+#endif
+
+//==============================================================================
+namespace RealtimeCheck
+{
+    static thread_local bool checking = false;
+    static std::atomic<int> numViolations { 0 };
+
+    // Beyond this many, violations are counted but their stack traces aren't printed.
+    static constexpr int maxReportedViolations = 20;
+
+    static void reportViolation (const char* what) noexcept
+    {
+        if (! checking)
+            return;
+
+        // Writing the report allocates, and that mustn't count.
+        checking = false;
+
+        auto n = ++numViolations;
+
+        if (n <= maxReportedViolations)
+            std::cerr << "\nReal-time violation #" << n << ": " << what << " during processBlock\n"
+                      << juce::SystemStats::getStackBacktrace() << std::flush;
+
+        checking = true;
+    }
+
+    ScopedRealtimeCheck::ScopedRealtimeCheck() noexcept     { checking = true; }
+    ScopedRealtimeCheck::~ScopedRealtimeCheck() noexcept    { checking = false; }
+
+    int getNumViolations() noexcept                         { return numViolations.load(); }
+
+    bool canDetectLocks() noexcept                          { return REALTIME_CHECK_INTERPOSE_LIBC != 0; }
+}
+
+//==============================================================================
+// The allocator underneath, bypassing the checks.
+#if REALTIME_CHECK_INTERPOSE_LIBC
+extern "C"
+{
+    void* __libc_malloc (size_t);
+    void* __libc_calloc (size_t, size_t);
+    void* __libc_realloc (void*, size_t);
+    void* __libc_memalign (size_t, size_t);
+    void  __libc_free (void*);
+}
+
+static void* rawAllocate (size_t size) noexcept                        { return __libc_malloc (size); }
+static void* rawAllocateAligned (size_t size, size_t alignment) noexcept  { return __libc_memalign (alignment, size); }
+static void  rawFree (void* p) noexcept                                 { __libc_free (p); }
+static void  rawFreeAligned (void* p) noexcept                          { __libc_free (p); }
+#elif JUCE_WINDOWS
+static void* rawAllocate (size_t size) noexcept                        { return std::malloc (size); }
+static void* rawAllocateAligned (size_t size, size_t alignment) noexcept  { return _aligned_malloc (size, alignment); }
+static void  rawFree (void* p) noexcept                                 { std::free (p); }
+static void  rawFreeAligned (void* p) noexcept                          { _aligned_free (p); }
+#else
+static void* rawAllocate (size_t size) noexcept                        { return std::malloc (size); }
+static void  rawFree (void* p) noexcept                                 { std::free (p); }
+static void  rawFreeAligned (void* p) noexcept                          { std::free (p); }
+
+static void* rawAllocateAligned (size_t size, size_t alignment) noexcept
+{
+    void* p = nullptr;
+    return posix_memalign (&p, juce::jmax (alignment, sizeof (void*)), size) == 0 ? p : nullptr;
+}
+#endif
+
+//==============================================================================
+// Replacements for every form of the global operator new and delete.
+static void* checkedNew (size_t size)
+{
+    RealtimeCheck::reportViolation ("operator new");
+
+    if (auto* p = rawAllocate (size == 0 ? 1 : size))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+static void* checkedNew (size_t size, std::align_val_t alignment)
+{
+    RealtimeCheck::reportViolation ("operator new");
+
+    if (auto* p = rawAllocateAligned (size == 0 ? 1 : size, (size_t) alignment))
+        return p;
+
+    throw std::bad_alloc();
+}
+
+static void checkedDelete (void* p) noexcept
+{
+    if (p != nullptr)
+        RealtimeCheck::reportViolation ("operator delete");
+
+    rawFree (p);
+}
+
+static void checkedDeleteAligned (void* p) noexcept
+{
+    if (p != nullptr)
+        RealtimeCheck::reportViolation ("operator delete");
+
+    rawFreeAligned (p);
+}
+
+void* operator new   (size_t size)                                                   { return checkedNew (size); }
+void* operator new[] (size_t size)                                                   { return checkedNew (size); }
+void* operator new   (size_t size, const std::nothrow_t&) noexcept                   { try { return checkedNew (size); } catch (...) { return nullptr; } }
+void* operator new[] (size_t size, const std::nothrow_t&) noexcept                   { try { return checkedNew (size); } catch (...) { return nullptr; } }
+void* operator new   (size_t size, std::align_val_t a)                               { return checkedNew (size, a); }
+void* operator new[] (size_t size, std::align_val_t a)                               { return checkedNew (size, a); }
+void* operator new   (size_t size, std::align_val_t a, const std::nothrow_t&) noexcept  { try { return checkedNew (size, a); } catch (...) { return nullptr; } }
+void* operator new[] (size_t size, std::align_val_t a, const std::nothrow_t&) noexcept  { try { return checkedNew (size, a); } catch (...) { return nullptr; } }
+
+void operator delete   (void* p) noexcept                                            { checkedDelete (p); }
+void operator delete[] (void* p) noexcept                                            { checkedDelete (p); }
+void operator delete   (void* p, size_t) noexcept                                    { checkedDelete (p); }
+void operator delete[] (void* p, size_t) noexcept                                    { checkedDelete (p); }
+void operator delete   (void* p, const std::nothrow_t&) noexcept                     { checkedDelete (p); }
+void operator delete[] (void* p, const std::nothrow_t&) noexcept                     { checkedDelete (p); }
+void operator delete   (void* p, std::align_val_t) noexcept                          { checkedDeleteAligned (p); }
+void operator delete[] (void* p, std::align_val_t) noexcept                          { checkedDeleteAligned (p); }
+void operator delete   (void* p, size_t, std::align_val_t) noexcept                  { checkedDeleteAligned (p); }
+void operator delete[] (void* p, size_t, std::align_val_t) noexcept                  { checkedDeleteAligned (p); }
+void operator delete   (void* p, std::align_val_t, const std::nothrow_t&) noexcept   { checkedDeleteAligned (p); }
+void operator delete[] (void* p, std::align_val_t, const std::nothrow_t&) noexcept   { checkedDeleteAligned (p); }
+
+//==============================================================================
+#if REALTIME_CHECK_INTERPOSE_LIBC
+// Symbols defined in the executable take precedence over the C library's, so
+// these catch calls made from any library as well as our own code.
+extern "C"
+{
+    void* malloc (size_t size) noexcept
+    {
+        RealtimeCheck::reportViolation ("malloc");
+        return __libc_malloc (size);
+    }
+
+    void* calloc (size_t count, size_t size) noexcept
+    {
+        RealtimeCheck::reportViolation ("calloc");
+        return __libc_calloc (count, size);
+    }
+
+    void* realloc (void* p, size_t size) noexcept
+    {
+        RealtimeCheck::reportViolation ("realloc");
+        return __libc_realloc (p, size);
+    }
+
+    void* memalign (size_t alignment, size_t size) noexcept
+    {
+        RealtimeCheck::reportViolation ("memalign");
+        return __libc_memalign (alignment, size);
+    }
+
+    void* aligned_alloc (size_t alignment, size_t size) noexcept
+    {
+        RealtimeCheck::reportViolation ("aligned_alloc");
+        return __libc_memalign (alignment, size);
+    }
+
+    int posix_memalign (void** result, size_t alignment, size_t size) noexcept
+    {
+        RealtimeCheck::reportViolation ("posix_memalign");
+        *result = __libc_memalign (alignment, size);
+        return *result != nullptr ? 0 : ENOMEM;
+    }
+
+    void free (void* p) noexcept
+    {
+        if (p != nullptr)
+            RealtimeCheck::reportViolation ("free");
+
+        __libc_free (p);
+    }
+}
+
+// The real lock functions, looked up the first time each is needed. The lookup
+// can't use a function-local static, as guarding that would take a lock.
+template <typename FunctionType>
+static FunctionType findNext (std::atomic<FunctionType>& cache, const char* name) noexcept
+{
+    auto fn = cache.load (std::memory_order_acquire);
+
+    if (fn == nullptr)
+    {
+        fn = reinterpret_cast<FunctionType> (dlsym (RTLD_NEXT, name));
+        cache.store (fn, std::memory_order_release);
+    }
+
+    return fn;
+}
+
+#define REALTIME_CHECK_INTERPOSE_LOCK(name, ParameterType) \
+    static std::atomic<int (*) (ParameterType*)> real_##name { nullptr }; \
+    extern "C" int name (ParameterType* lock) noexcept \
+    { \
+        RealtimeCheck::reportViolation (#name); \
+        return findNext (real_##name, #name) (lock); \
+    }
+
+REALTIME_CHECK_INTERPOSE_LOCK (pthread_mutex_lock,    pthread_mutex_t)
+REALTIME_CHECK_INTERPOSE_LOCK (pthread_rwlock_rdlock, pthread_rwlock_t)
+REALTIME_CHECK_INTERPOSE_LOCK (pthread_rwlock_wrlock, pthread_rwlock_t)
+
+#undef REALTIME_CHECK_INTERPOSE_LOCK
+
+static std::atomic<int (*) (pthread_cond_t*, pthread_mutex_t*)> real_pthread_cond_wait { nullptr };
+
+extern "C" int pthread_cond_wait (pthread_cond_t* condition, pthread_mutex_t* mutex) noexcept
+{
+    RealtimeCheck::reportViolation ("pthread_cond_wait");
+    return findNext (real_pthread_cond_wait, "pthread_cond_wait") (condition, mutex);
+}
+#endif
+
+//==============================================================================
+namespace
+{
+    /** A processor set up in a particular way before it's run. */
+    struct Scenario
+    {
+        juce::String name;
+        std::function<std::unique_ptr<juce::AudioProcessor>()> create;
+        std::vector<std::pair<juce::String, float>> settings;
+        bool withAnalyzer = false;
+    };
+
+    struct SimulatedAudioThread  : public juce::Thread
+    {
+        explicit SimulatedAudioThread (std::function<void()> toRun)
+            : juce::Thread ("Simulated Audio Thread"), work (std::move (toRun)) {}
+
+        void run() override     { work(); }
+
+        std::function<void()> work;
+    };
+
+    juce::RangedAudioParameter* findParameter (juce::AudioProcessor& processor, const juce::String& paramID)
+    {
+        for (auto* p : processor.getParameters())
+            if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (p))
+                if (ranged->paramID == paramID)
+                    return ranged;
+
+        return nullptr;
+    }
+
+    /** Plays noise through the processor the way a host would, checking every
+        processBlock call. Returns the number of violations.
+    */
+    template <typename SampleType>
+    int runScenario (const Scenario& scenario, double sampleRate, int blockSize, double secondsOfAudio)
+    {
+        auto processor = scenario.create();
+
+        for (auto& [paramID, value] : scenario.settings)
+            if (auto* parameter = findParameter (*processor, paramID))
+                parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add (juce::AudioChannelSet::stereo());
+        layout.outputBuses.add (juce::AudioChannelSet::stereo());
+
+        if (! processor->setBusesLayout (layout))
+            return 0;
+
+        processor->setProcessingPrecision (std::is_same_v<SampleType, double> ? juce::AudioProcessor::doublePrecision
+                                                                               : juce::AudioProcessor::singlePrecision);
+        processor->setRateAndBufferSizeDetails (sampleRate, blockSize);
+        processor->prepareToPlay (sampleRate, blockSize);
+
+        std::unique_ptr<SpectrumAnalyzer> analyzer;
+
+        if (scenario.withAnalyzer)
+            if (auto* eq = dynamic_cast<SimpleEQAudioProcessor*> (processor.get()))
+                analyzer = std::make_unique<SpectrumAnalyzer> (*eq);
+
+        // The parameters a host could automate during playback.
+        juce::Array<juce::AudioProcessorParameter*> automatable;
+
+        for (auto* p : processor->getParameters())
+            if (p->isAutomatable())
+                automatable.add (p);
+
+        juce::AudioBuffer<SampleType> buffer (2, blockSize);
+        juce::MidiBuffer midi;
+        midi.ensureSize (1024);
+        juce::Random random (0x5eed);
+
+        auto numBlocks = juce::jmax (32, juce::roundToInt (secondsOfAudio * sampleRate / blockSize));
+        auto before = RealtimeCheck::getNumViolations();
+
+        SimulatedAudioThread audioThread ([&]
+        {
+            for (int block = 0; block < numBlocks; ++block)
+            {
+                // Like a plug-in wrapper, apply the host's automation on the
+                // audio thread just before the callback.
+                if (block % 8 == 0)
+                {
+                    for (auto* p : automatable)
+                    {
+                        auto value = random.nextFloat();
+                        p->setValue (value);
+                        p->sendValueChangedMessageToListeners (value);
+                    }
+                }
+
+                // A few controller moves, some of which the processors map to parameters.
+                midi.clear();
+
+                for (int i = 0; i < 4; ++i)
+                    midi.addEvent (juce::MidiMessage::controllerEvent (1, random.nextInt (32), random.nextInt (128)),
+                                   random.nextInt (blockSize));
+
+                for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+                    for (int i = 0; i < blockSize; ++i)
+                        buffer.setSample (ch, i, (SampleType) (0.25f * (random.nextFloat() * 2.0f - 1.0f)));
+
+                {
+                    const RealtimeCheck::ScopedRealtimeCheck check;
+                    processor->processBlock (buffer, midi);
+                }
+            }
+        });
+
+        audioThread.startThread (juce::Thread::Priority::highest);
+        audioThread.waitForThreadToExit (-1);
+
+        analyzer.reset();
+        processor->releaseResources();
+
+        return RealtimeCheck::getNumViolations() - before;
+    }
+}
+
+//==============================================================================
+void runRealtimeCheck (const juce::ArgumentList& args)
+{
+    auto simpleEQ = [] { return std::make_unique<SimpleEQAudioProcessor>(); };
+
+    std::vector<std::pair<juce::String, float>> bands { { "LowCut Freq",  80.0f },    { "LowCut Slope",  3.0f },
+                                                        { "Peak Freq",    1000.0f },  { "Peak Gain",     6.0f },
+                                                        { "HighCut Freq", 12000.0f }, { "HighCut Slope", 3.0f } };
+
+    auto with = [] (std::vector<std::pair<juce::String, float>> settings, std::vector<std::pair<juce::String, float>> more)
+    {
+        settings.insert (settings.end(), more.begin(), more.end());
+        return settings;
+    };
+
+    std::vector<Scenario> scenarios
+    {
+        { "SimpleEQ",              simpleEQ, {} },
+        { "SimpleEQ bands",        simpleEQ, bands },
+        { "SimpleEQ linear phase", simpleEQ, with (bands, { { "LowCut Mode", 1.0f } }) },
+        { "SimpleEQ 2x IIR",       simpleEQ, with (bands, { { "Oversampling", 1.0f } }) },
+        { "SimpleEQ 8x FIR",       simpleEQ, with (bands, { { "Oversampling", 3.0f }, { "Oversampling Filter", 1.0f } }) },
+        { "SimpleEQ SVF",          simpleEQ, with (bands, { { "Filter Engine", 1.0f } }) },
+        { "SimpleEQ analyzer",     simpleEQ, bands, true },
+        { "Tutorial 1", [] { return std::make_unique<TutorialStep1::TutorialProcessor>(); }, {} },
+        { "Tutorial 2", [] { return std::make_unique<TutorialStep2::TutorialProcessor>(); }, {} },
+        { "Tutorial 3", [] { return std::make_unique<TutorialStep3::TutorialProcessor>(); }, {} },
+        { "Tutorial 4", [] { return std::make_unique<TutorialStep4::TutorialProcessor>(); }, {} }
+    };
+
+    if (args.containsOption ("--processor"))
+    {
+        auto wanted = args.getValueForOption ("--processor");
+        scenarios.erase (std::remove_if (scenarios.begin(), scenarios.end(),
+                                         [&] (const Scenario& s) { return ! s.name.startsWithIgnoreCase (wanted); }),
+                         scenarios.end());
+
+        if (scenarios.empty())
+            juce::ConsoleApplication::fail ("Unknown processor: " + wanted);
+    }
+
+    if (! RealtimeCheck::canDetectLocks())
+        std::cout << "Note: only operator new and delete are checked on this platform, not malloc or locks" << std::endl;
+
+    auto failed = 0;
+
+    for (auto& scenario : scenarios)
+    {
+        auto precisions = scenario.create()->supportsDoublePrecisionProcessing() ? 2 : 1;
+
+        for (int precision = 0; precision < precisions; ++precision)
+        {
+            for (auto blockSize : { 1, 64, 480, 4096 })
+            {
+                auto violations = precision == 0 ? runScenario<float>  (scenario, 48000.0, blockSize, 0.5)
+                                                 : runScenario<double> (scenario, 48000.0, blockSize, 0.5);
+
+                std::cout << scenario.name.paddedRight (' ', 24)
+                          << (precision == 0 ? "f32" : "f64")
+                          << juce::String (blockSize).paddedLeft (' ', 6) << " smp  "
+                          << (violations == 0 ? juce::String ("ok") : juce::String (violations) + " violations") << std::endl;
+
+                if (violations > 0)
+                    ++failed;
+            }
+        }
+    }
+
+    if (failed > 0)
+        juce::ConsoleApplication::fail (juce::String (failed) + " configurations allocated or locked in processBlock");
+
+    std::cout << "No allocations or locks in processBlock" << std::endl;
+}
@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+    RealtimeCheck.h
+    Catches processBlock allocating or locking.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    While a ScopedRealtimeCheck is alive on a thread, any call on that thread
+    to operator new or delete is reported, with a stack trace. Where the C
+    library allows them to be interposed (glibc on Linux) so are malloc, free
+    and friends, and taking a pthread mutex, read-write lock or condition
+    variable.
+
+    The replacements forward to the real allocator and lock, so the program
+    carries on after a violation and every one in a run is reported.
+*/
+namespace RealtimeCheck
+{
+    /** Marks the current thread as running audio for as long as it exists. */
+    struct ScopedRealtimeCheck
+    {
+        ScopedRealtimeCheck() noexcept;
+        ~ScopedRealtimeCheck() noexcept;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedRealtimeCheck)
+    };
+
+    /** The number of violations reported since the program started. */
+    int getNumViolations() noexcept;
+
+    /** True if locks are being checked as well as allocations on this platform. */
+    bool canDetectLocks() noexcept;
+}
+
+/** The --rt-check command: runs every processor under a simulated host and
+    fails if processBlock allocates or locks.
+*/
+void runRealtimeCheck (const juce::ArgumentList& args);
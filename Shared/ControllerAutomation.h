@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    ControllerAutomation.h
+    Sample-accurate parameter changes from MIDI controllers.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Maps MIDI controller numbers to a processor's parameters, and splits each
+    block at the controller events so that a change lands on exactly the
+    sample the event is timestamped with, rather than on the next block.
+
+        controllers.process (midi, buffer.getNumSamples(),
+                             [&] (int slot, float value)   { ...apply the change... },
+                             [&] (int start, int length)   { ...process the samples... });
+
+    A slot is whatever index the processor gave the controller in
+    mapController(); the value is the controller's position from 0 to 1.
+    Events at the same sample are applied together before the segment that
+    starts there, so a block is only split where something changes.
+
+    The MIDI is scanned once and nothing else is done per sample: the cost
+    is one segment per event, so a block with no mapped events is processed
+    in one go exactly as before. Nothing allocates or locks, so process() is
+    safe on the audio thread.
+
+    JUCE doesn't pass plug-ins the timestamps of host automation, which still
+    arrives once per block through the parameters themselves.
+*/
+class ControllerAutomation
+{
+public:
+    ControllerAutomation() noexcept     { slots.fill (-1); }
+
+    /** Routes a controller (0 to 127, on any channel) to a slot, or with -1, nowhere. */
+    void mapController (int controllerNumber, int slot) noexcept
+    {
+        jassert (juce::isPositiveAndBelow (controllerNumber, 128) && slot >= -1 && slot < 128);
+        slots[(size_t) controllerNumber] = (juce::int8) slot;
+    }
+
+    /** The slot a controller is routed to, or -1. */
+    int getSlot (int controllerNumber) const noexcept
+    {
+        return juce::isPositiveAndBelow (controllerNumber, 128) ? slots[(size_t) controllerNumber] : -1;
+    }
+
+    /** Calls applyEvent (slot, value) for each mapped controller event, and
+        processSegment (startSample, numSamples) for each stretch of the block
+        between them. The segments cover the whole block, in order.
+    */
+    template <typename ApplyEvent, typename ProcessSegment>
+    void process (const juce::MidiBuffer& midi, int numSamples,
+                  ApplyEvent&& applyEvent, ProcessSegment&& processSegment) const
+    {
+        auto segmentStart = 0;
+
+        for (const auto metadata : midi)
+        {
+            if (metadata.numBytes < 3 || (metadata.data[0] & 0xf0) != 0xb0)
+                continue;
+
+            auto slot = slots[(size_t) (metadata.data[1] & 0x7f)];
+
+            if (slot < 0)
+                continue;
+
+            // Events stamped outside the block are applied at its edges.
+            auto position = juce::jlimit (0, numSamples, metadata.samplePosition);
+
+            if (position > segmentStart)
+            {
+                processSegment (segmentStart, position - segmentStart);
+                segmentStart = position;
+            }
+
+            applyEvent ((int) slot, (float) (metadata.data[2] & 0x7f) / 127.0f);
+        }
+
+        if (segmentStart < numSamples)
+            processSegment (segmentStart, numSamples - segmentStart);
+    }
+
+private:
+    std::array<juce::int8, 128> slots;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ControllerAutomation)
+};
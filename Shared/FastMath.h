@@ -0,0 +1,306 @@
+/*
+  ==============================================================================
+
+    FastMath.h
+    Branch-free approximations of the transcendental functions used to turn
+    parameters into filter coefficients and gains.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Each function here is a range reduction followed by a short polynomial,
+    for float and double, with no branches, table lookups or library calls.
+    That makes a loop calling one over an array something the compiler can
+    vectorise at -O3, so a whole buffer of per-sample coefficients costs a
+    few cycles a value. The float versions vectorise with SSE2 or NEON. Apart
+    from tan(), the double ones pick between results on 64-bit integer
+    lanes, which need SSE4.2, AVX2 or arm64; built for plain SSE2 they run a
+    value at a time, and are no faster than the std:: functions.
+
+    Where a choice has to be made between two results it's made on their
+    bits with select(), or by blending them with a 0 or 1 weight, rather
+    than with a ?:. Compilers won't vectorise a ?: whose result goes on into
+    floating-point arithmetic unless floating-point traps are switched off:
+    they turn it back into a branch.
+
+    Each function documents its largest error over a domain, as "double /
+    float". `ProcessorBenchmark --fast-math` checks every bound against the
+    std:: functions in long double, and times each function against its
+    std:: equivalent.
+*/
+namespace FastMath
+{
+    namespace detail
+    {
+        template <typename T>
+        struct Traits;
+
+        template <>
+        struct Traits<float>
+        {
+            using Int = juce::int32;
+            static constexpr int mantissaBits = 23, exponentBias = 127;
+        };
+
+        template <>
+        struct Traits<double>
+        {
+            using Int = juce::int64;
+            static constexpr int mantissaBits = 52, exponentBias = 1023;
+        };
+
+        template <typename To, typename From>
+        inline To bitCast (From value) noexcept
+        {
+            static_assert (sizeof (To) == sizeof (From), "Can only reinterpret types of the same size");
+            To result;
+            std::memcpy (&result, &value, sizeof (To));
+            return result;
+        }
+
+        /** 1 if the condition holds, otherwise 0, as a weight for a blend. */
+        template <typename T>
+        inline T weight (bool condition) noexcept           { return condition ? (T) 1 : (T) 0; }
+
+        /** a if the condition holds, otherwise b, chosen with a mask on their bits. */
+        template <typename T>
+        inline T select (bool condition, T a, T b) noexcept
+        {
+            using Int = typename Traits<T>::Int;
+            auto mask = -(Int) (condition ? 1 : 0);
+            return bitCast<T> ((bitCast<Int> (a) & mask) | (bitCast<Int> (b) & ~mask));
+        }
+
+        /** The largest whole number not above x, for |x| < 2^31. The correction
+            for negative x is made on the integer, as compilers won't vectorise
+            a float select that depends on a conversion.
+        */
+        template <typename T>
+        inline int floor (T x) noexcept
+        {
+            auto truncated = (int) x;
+            return truncated - ((T) truncated > x ? 1 : 0);
+        }
+
+        /** Evaluates a polynomial by Horner's method, coefficients highest power
+            first. The fold unrolls it completely, so there's no loop left in a
+            loop that calls it.
+        */
+        template <typename T, typename... Coefficients>
+        inline T polynomial (T x, double highest, Coefficients... rest) noexcept
+        {
+            auto result = (T) highest;
+            ((result = result * x + (T) rest), ...);
+            return result;
+        }
+    }
+
+    //==============================================================================
+    /** tan (x) for |x| <= 0.49 pi, as numerator / denominator, so that a caller
+        that needs 1 / (1 + tan (x) ...) can fold the two divisions into one.
+
+        Arguments above pi / 4 are reflected, as tan (x) = 1 / tan (pi / 2 - x),
+        so the [5/4] Pade approximant is only used where it's accurate.
+        Relative error 1.4e-8 / 3e-6; in float, most of that is rounding
+        pi / 2 - x close to 0.49 pi.
+    */
+    template <typename T>
+    inline void tan (T x, T& numerator, T& denominator) noexcept
+    {
+        constexpr auto quarterPi = juce::MathConstants<T>::pi / 4;
+        constexpr auto halfPi    = juce::MathConstants<T>::halfPi;
+
+        auto sign = (T) 1 - (T) 2 * detail::weight<T> (x < 0);
+        x *= sign;
+
+        auto reflect = detail::weight<T> (x > quarterPi);
+        auto y  = x + reflect * (halfPi - x - x);
+        auto y2 = y * y;
+        auto p  = y * ((T) 945 - y2 * ((T) 105 - y2));
+        auto q  = (T) 945 - y2 * ((T) 420 - (T) 15 * y2);
+
+        numerator   = sign * (p + reflect * (q - p));
+        denominator = q + reflect * (p - q);
+    }
+
+    /** tan (x) for |x| <= 0.49 pi, to within the same bounds. */
+    template <typename T>
+    inline T tan (T x) noexcept
+    {
+        T numerator, denominator;
+        tan (x, numerator, denominator);
+        return numerator / denominator;
+    }
+
+    //==============================================================================
+    /** 2^x. Relative error 4e-16 / 3e-7 for |x| <= 100. Results that would
+        be denormal or overflow are held to the smallest and largest normal
+        powers of two, so this never returns 0 or infinity.
+    */
+    template <typename T>
+    inline T exp2 (T x) noexcept
+    {
+        using Traits = detail::Traits<T>;
+
+        constexpr auto minExponent = (T) (1 - Traits::exponentBias);
+        constexpr auto maxExponent = (T) Traits::exponentBias;
+
+        x = detail::select (x < minExponent, minExponent, x);
+        x = detail::select (x > maxExponent, maxExponent, x);
+
+        // 2^x = 2^n * e^(f ln 2), with |f| <= 1/2 so the Taylor series of e^u
+        // converges quickly: the first omitted term is below 2e-16 in double
+        // and 2e-8 in float.
+        auto n = detail::floor (x + (T) 0.5);
+        auto u = (x - (T) n) * (T) 0.69314718055994531;   // ln 2
+
+        T power;
+
+        if constexpr (std::is_same_v<T, float>)
+            power = detail::polynomial (u, 1.0 / 720, 1.0 / 120, 1.0 / 24, 1.0 / 6, 0.5, 1.0, 1.0);
+        else
+            power = detail::polynomial (u, 1.0 / 479001600, 1.0 / 39916800, 1.0 / 3628800, 1.0 / 362880, 1.0 / 40320,
+                                             1.0 / 5040, 1.0 / 720, 1.0 / 120, 1.0 / 24, 1.0 / 6, 0.5, 1.0, 1.0);
+
+        // n is within the normal exponents, so 2^n can be built from its bits.
+        auto scale = detail::bitCast<T> ((typename Traits::Int) (n + Traits::exponentBias) << Traits::mantissaBits);
+
+        return power * scale;
+    }
+
+    /** e^x. Relative error 2e-15 / 1.5e-6 for |x| <= 20, growing with |x| as
+        the rounding of x * log2 (e) does. Held away from 0 and infinity as
+        exp2() is.
+    */
+    template <typename T>
+    inline T exp (T x) noexcept                         { return exp2 (x * (T) 1.4426950408889634); }
+
+    /** 10^x. Relative error 3e-15 / 1.5e-6 for |x| <= 6, growing with |x| as
+        exp() does. Held away from 0 and infinity as exp2() is.
+    */
+    template <typename T>
+    inline T pow10 (T x) noexcept                       { return exp2 (x * (T) 3.3219280948873623); }
+
+    //==============================================================================
+    /** log2 (x) for x > 0. Absolute error 2e-15 / 1e-6 from 1e-6 to 1000,
+        which is a couple of ulps of the result. Anything below the smallest
+        normal number, including 0, is taken to be that number.
+    */
+    template <typename T>
+    inline T log2 (T x) noexcept
+    {
+        using Traits = detail::Traits<T>;
+        using Int = typename Traits::Int;
+
+        constexpr auto mantissaMask = ((Int) 1 << Traits::mantissaBits) - 1;
+
+        x = detail::select (x < std::numeric_limits<T>::min(), std::numeric_limits<T>::min(), x);
+
+        // x = 2^e * m, with m in [sqrt (1/2), sqrt (2)).
+        auto bits = detail::bitCast<Int> (x);
+        auto e = (T) (int) ((bits >> Traits::mantissaBits) - Traits::exponentBias);
+        auto m = detail::bitCast<T> ((bits & mantissaMask) | ((Int) Traits::exponentBias << Traits::mantissaBits));
+
+        auto halve = m > juce::MathConstants<T>::sqrt2;
+        m = detail::select (halve, m * (T) 0.5, m);
+        e = detail::select (halve, e + (T) 1, e);
+
+        // ln m = 2 atanh (t), with |t| <= 0.172, so the series in odd powers of
+        // t converges quickly: the first omitted term is below 1e-17 in double
+        // and 3e-8 in float.
+        auto t  = (m - (T) 1) / (m + (T) 1);
+        auto t2 = t * t;
+
+        T series;
+
+        if constexpr (std::is_same_v<T, float>)
+            series = detail::polynomial (t2, 1.0 / 7, 1.0 / 5, 1.0 / 3, 1.0);
+        else
+            series = detail::polynomial (t2, 1.0 / 19, 1.0 / 17, 1.0 / 15, 1.0 / 13, 1.0 / 11,
+                                               1.0 / 9, 1.0 / 7, 1.0 / 5, 1.0 / 3, 1.0);
+
+        return e + (T) 2.8853900817779268 * t * series;   // 2 / ln 2
+    }
+
+    //==============================================================================
+    /** Decibels to a gain, like juce::Decibels::decibelsToGain(). Relative
+        error 2e-15 / 1e-6 from -100 to +60 dB. At or below minusInfinityDb
+        the gain is 0.
+    */
+    template <typename T>
+    inline T decibelsToGain (T decibels, T minusInfinityDb = (T) -100) noexcept
+    {
+        return detail::select (decibels > minusInfinityDb, exp2 (decibels * (T) 0.16609640474436813), (T) 0);
+    }
+
+    /** A gain in decibels, like juce::Decibels::gainToDecibels(). Absolute
+        error 1.5e-14 / 6e-6 dB for gains from 1e-5 to 100. Gains that would
+        come out below minusInfinityDb, including 0, give minusInfinityDb.
+    */
+    template <typename T>
+    inline T gainToDecibels (T gain, T minusInfinityDb = (T) -100) noexcept
+    {
+        auto decibels = log2 (gain) * (T) 6.0205999132796239;
+        return detail::select (decibels > minusInfinityDb, decibels, minusInfinityDb);
+    }
+
+    //==============================================================================
+    namespace detail
+    {
+        /** sin or cos of x, as sin (x + quadrantOffset * pi / 2). */
+        template <typename T>
+        inline T sinQuadrant (T x, int quadrantOffset) noexcept
+        {
+            // x = n pi / 2 + r, with |r| <= pi / 4. pi / 2 is split into parts
+            // whose products with n are exact, so r doesn't lose the bits that
+            // n pi / 2 cancels.
+            auto quadrant = floor (x * (T) 0.63661977236758134 + (T) 0.5);
+            auto n = (T) quadrant;
+            T r;
+
+            if constexpr (std::is_same_v<T, float>)
+                r = ((x - n * 1.5703125f) - n * 4.837512969970703125e-4f) - n * 7.549789948768648e-8f;
+            else
+                r = (x - n * 1.57079632673412561417) - n * 6.07710050650619224932e-11;
+
+            auto r2 = r * r;
+            T s, c;
+
+            // Taylor series: the first omitted terms are below 1e-16 in double
+            // and 3e-8 in float.
+            if constexpr (std::is_same_v<T, float>)
+            {
+                s = r * polynomial (r2, 1.0 / 362880, -1.0 / 5040, 1.0 / 120, -1.0 / 6, 1.0);
+                c = polynomial (r2, 1.0 / 40320, -1.0 / 720, 1.0 / 24, -0.5, 1.0);
+            }
+            else
+            {
+                s = r * polynomial (r2, -1.0 / 1307674368000.0, 1.0 / 6227020800.0, -1.0 / 39916800, 1.0 / 362880,
+                                          -1.0 / 5040, 1.0 / 120, -1.0 / 6, 1.0);
+                c = polynomial (r2, 1.0 / 20922789888000.0, -1.0 / 87178291200.0, 1.0 / 479001600, -1.0 / 3628800,
+                                      1.0 / 40320, -1.0 / 720, 1.0 / 24, -0.5, 1.0);
+            }
+
+            // Quadrants 1 and 3 take the cosine, 2 and 3 are negated.
+            quadrant += quadrantOffset;
+            auto result = select ((quadrant & 1) != 0, c, s);
+            return select ((quadrant & 2) != 0, -result, result);
+        }
+    }
+
+    /** sin (x). Absolute error 2.5e-16 / 1.5e-7 for |x| up to 1e6 / 8192;
+        beyond that the range reduction loses accuracy.
+    */
+    template <typename T>
+    inline T sin (T x) noexcept                         { return detail::sinQuadrant (x, 0); }
+
+    /** cos (x), to the same bounds as sin(). */
+    template <typename T>
+    inline T cos (T x) noexcept                         { return detail::sinQuadrant (x, 1); }
+}
@@ -0,0 +1,271 @@
+/*
+  ==============================================================================
+
+    ParameterTable.h
+    A processor's parameters declared once, in a compile-time table.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** One row of a parameter table: everything needed to create the parameter
+    and to save and restore it.
+*/
+struct ParameterDescriptor
+{
+    enum Type { floatType, boolType };
+
+    const char* id;
+    const char* name;
+    Type type;
+    float minimum, maximum, defaultValue;
+
+    /** A hash of the ID, which identifies the parameter in saved state. */
+    constexpr juce::uint32 getIdHash() const noexcept
+    {
+        // FNV-1a
+        juce::uint32 hash = 2166136261u;
+
+        for (auto* c = id; *c != 0; ++c)
+            hash = (hash ^ (juce::uint8) *c) * 16777619u;
+
+        return hash;
+    }
+};
+
+//==============================================================================
+/**
+    The parameters described by a table, with everything a processor would
+    otherwise write out by hand for each one generated from it.
+
+    The table is a struct with a constexpr array of descriptors, and an enum
+    naming their indices:
+
+        struct MyParameters
+        {
+            enum Index { gain, bypass };
+
+            static constexpr std::array<ParameterDescriptor, 2> descriptors
+            {{
+                { "gain",   "Gain",   ParameterDescriptor::floatType, 0.0f, 1.0f, 0.5f },
+                { "bypass", "Bypass", ParameterDescriptor::boolType,  0.0f, 1.0f, 0.0f }
+            }};
+        };
+
+        ParameterSet<MyParameters> parameters;
+
+        parameters.addTo (*this);                       // in the constructor
+        auto g = parameters.get<MyParameters::gain>();  // a float, on the audio thread
+
+    get() returns a float or a bool as the table says, chosen at compile time,
+    so reading a parameter on the audio thread is a single atomic load.
+
+    The state is binary: a header, then each parameter's ID hash and value,
+    eight bytes a parameter, written straight into the host's block with no
+    XML or strings in between. Parameters are matched by ID when it's read
+    back, so rows can be added, reordered or removed without breaking saved
+    sessions: anything missing from the state keeps its value. Duplicate IDs,
+    and IDs whose hashes collide, fail to compile.
+*/
+template <typename Table>
+class ParameterSet
+{
+public:
+    static constexpr auto& descriptors = Table::descriptors;
+    static constexpr int numParameters = (int) descriptors.size();
+
+    /** The size of the state that writeState() writes. */
+    static constexpr size_t stateSize = 8 + 8 * (size_t) numParameters;
+
+    /** The index of the row with the given ID, or -1. */
+    static constexpr int indexOf (const char* id) noexcept
+    {
+        for (int i = 0; i < numParameters; ++i)
+            if (idsMatch (descriptors[(size_t) i].id, id))
+                return i;
+
+        return -1;
+    }
+
+    //==============================================================================
+    ParameterSet() = default;
+
+    /** Creates every parameter in the table and adds it to the processor, in
+        table order. Call once, from the processor's constructor.
+    */
+    void addTo (juce::AudioProcessor& processor)
+    {
+        static_assert (hasUniqueIds(), "Every parameter in the table needs an ID of its own");
+
+        for (size_t i = 0; i < descriptors.size(); ++i)
+        {
+            auto& d = descriptors[i];
+            juce::RangedAudioParameter* parameter;
+
+            if (d.type == ParameterDescriptor::boolType)
+                parameter = new juce::AudioParameterBool (d.id, d.name, d.defaultValue >= 0.5f);
+            else
+                parameter = new juce::AudioParameterFloat (d.id, d.name, d.minimum, d.maximum, d.defaultValue);
+
+            parameters[i] = parameter;
+            processor.addParameter (parameter);
+        }
+    }
+
+    /** The parameter in a row, as its own type. */
+    template <int index>
+    auto* getParameter() const noexcept
+    {
+        static_assert (index >= 0 && index < numParameters, "No such row in the parameter table");
+        jassert (parameters[(size_t) index] != nullptr);
+
+        if constexpr (descriptors[(size_t) index].type == ParameterDescriptor::boolType)
+            return static_cast<juce::AudioParameterBool*> (parameters[(size_t) index]);
+        else
+            return static_cast<juce::AudioParameterFloat*> (parameters[(size_t) index]);
+    }
+
+    /** The current value of the parameter in a row, as a float or a bool.
+        Doesn't lock or allocate, so it's safe on the audio thread.
+    */
+    template <int index>
+    auto get() const noexcept                   { return getParameter<index>()->get(); }
+
+    //==============================================================================
+    /** Replaces the block's contents with the state of every parameter. */
+    void writeState (juce::MemoryBlock& destData) const
+    {
+        destData.setSize (stateSize);
+        auto* out = static_cast<char*> (destData.getData());
+
+        writeWord (out, stateMagic);
+        writeWord (out + 4, (juce::uint32) numParameters);
+        out += 8;
+
+        for (size_t i = 0; i < descriptors.size(); ++i, out += 8)
+        {
+            writeWord (out, descriptors[i].getIdHash());
+            writeWord (out + 4, toBits (getValue (i)));
+        }
+    }
+
+    /** Restores the parameters saved in the state by writeState(), telling the
+        host about each. Returns false, and changes nothing, if the data isn't
+        state that writeState() wrote.
+    */
+    bool readState (const void* data, int sizeInBytes)
+    {
+        auto* in = static_cast<const char*> (data);
+
+        if (data == nullptr || sizeInBytes < 8 || readWord (in) != stateMagic)
+            return false;
+
+        auto numSaved = (int) readWord (in + 4);
+
+        if (numSaved < 0 || (size_t) sizeInBytes < 8 + 8 * (size_t) numSaved)
+            return false;
+
+        for (int i = 0; i < numSaved; ++i)
+        {
+            auto* entry = in + 8 + 8 * i;
+            auto index = findHash (readWord (entry), i);
+
+            if (index >= 0)
+                setValue ((size_t) index, fromBits (readWord (entry + 4)));
+        }
+
+        return true;
+    }
+
+    /** Restores the parameters from attributes named after their IDs, as
+        state saved as XML was written. Anything not in the element keeps its
+        value.
+    */
+    void readXml (const juce::XmlElement& xml)
+    {
+        for (size_t i = 0; i < descriptors.size(); ++i)
+            if (xml.hasAttribute (descriptors[i].id))
+                setValue (i, (float) xml.getDoubleAttribute (descriptors[i].id));
+    }
+
+private:
+    //==============================================================================
+    static constexpr juce::uint32 stateMagic = 0x31544150;   // "PAT1"
+
+    static constexpr bool idsMatch (const char* a, const char* b) noexcept
+    {
+        for (; *a != 0 && *a == *b; ++a, ++b) {}
+        return *a == *b;
+    }
+
+    static constexpr bool hasUniqueIds() noexcept
+    {
+        for (size_t i = 0; i < descriptors.size(); ++i)
+            for (size_t j = i + 1; j < descriptors.size(); ++j)
+                if (idsMatch (descriptors[i].id, descriptors[j].id)
+                     || descriptors[i].getIdHash() == descriptors[j].getIdHash())
+                    return false;
+
+        return true;
+    }
+
+    /** The row with the hash, trying the same row first, as the table has
+        usually not changed since the state was saved.
+    */
+    static int findHash (juce::uint32 hash, int likelyIndex) noexcept
+    {
+        if (juce::isPositiveAndBelow (likelyIndex, numParameters)
+             && descriptors[(size_t) likelyIndex].getIdHash() == hash)
+            return likelyIndex;
+
+        for (int i = 0; i < numParameters; ++i)
+            if (descriptors[(size_t) i].getIdHash() == hash)
+                return i;
+
+        return -1;
+    }
+
+    static void writeWord (char* dest, juce::uint32 value) noexcept
+    {
+        value = juce::ByteOrder::swapIfBigEndian (value);
+        std::memcpy (dest, &value, sizeof (value));
+    }
+
+    static juce::uint32 readWord (const char* source) noexcept    { return juce::ByteOrder::littleEndianInt (source); }
+
+    static juce::uint32 toBits (float value) noexcept
+    {
+        juce::uint32 bits;
+        std::memcpy (&bits, &value, sizeof (bits));
+        return bits;
+    }
+
+    static float fromBits (juce::uint32 bits) noexcept
+    {
+        float value;
+        std::memcpy (&value, &bits, sizeof (value));
+        return value;
+    }
+
+    float getValue (size_t index) const noexcept
+    {
+        jassert (parameters[index] != nullptr);
+        return parameters[index]->convertFrom0to1 (parameters[index]->getValue());
+    }
+
+    void setValue (size_t index, float value)
+    {
+        jassert (parameters[index] != nullptr);
+        auto* parameter = parameters[index];
+        parameter->setValueNotifyingHost (parameter->convertTo0to1 (value));
+    }
+
+    std::array<juce::RangedAudioParameter*, descriptors.size()> parameters {};
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE (ParameterSet)
+};
@@ -0,0 +1,297 @@
+/*
+  ==============================================================================
+
+    ProcessProfiler.cpp
+
+  ==============================================================================
+*/
+
+#include "ProcessProfiler.h"
+
+#if PROCESS_PROFILER_ENABLED
+
+//==============================================================================
+ProcessProfiler::ProcessProfiler (juce::StringArray stageNames)
+    : names (std::move (stageNames)),
+      ring ((size_t) ringSize),
+      histograms ((size_t) juce::jmax (1, names.size())),
+      firstCycles (readCycleCounter()),
+      firstSeconds (juce::Time::getMillisecondCounterHiRes() * 0.001)
+{
+    jassert (! names.isEmpty());
+
+    profilerThread->addTimeSliceClient (this);
+}
+
+ProcessProfiler::~ProcessProfiler()
+{
+    // Blocks until the profiler thread has finished with us.
+    profilerThread->removeTimeSliceClient (this);
+}
+
+void ProcessProfiler::push (const Event& event) noexcept
+{
+    const auto scope = fifo.write (1);
+
+    if (scope.blockSize1 > 0)
+        ring[(size_t) scope.startIndex1] = event;
+    else if (scope.blockSize2 > 0)
+        ring[(size_t) scope.startIndex2] = event;
+    else
+        dropped.fetch_add (1, std::memory_order_relaxed);
+}
+
+//==============================================================================
+int ProcessProfiler::useTimeSlice()
+{
+    const juce::ScopedLock sl (histogramLock);
+
+    updateCycleRate();
+
+    auto nsPerCycle = 1.0e9 / cyclesPerSecond;
+    auto sampleRate = currentSampleRate.load();
+
+    const auto scope = fifo.read (fifo.getNumReady());
+
+    auto add = [&] (const Event& event)
+    {
+        if (! juce::isPositiveAndBelow (event.stage, (int) histograms.size()) || event.end < event.start)
+            return;
+
+        auto& h = histograms[(size_t) event.stage];
+        auto ns = (double) (event.end - event.start) * nsPerCycle;
+
+        auto bucket = juce::jlimit (0, Histogram::numDurationBuckets - 1, (int) std::floor (10.0 * std::log10 (juce::jmax (1.0, ns))));
+        ++h.durations[(size_t) bucket];
+        ++h.count;
+        h.maxNs = juce::jmax (h.maxNs, ns);
+
+        if (event.numSamples > 0 && sampleRate > 0.0)
+        {
+            auto load = ns * 1.0e-9 * sampleRate / event.numSamples;
+            auto loadBucket = juce::jlimit (0, Histogram::numLoadBuckets - 1, (int) std::floor (load / 0.005));
+
+            ++h.loads[(size_t) loadBucket];
+            h.maxLoad = juce::jmax (h.maxLoad, load);
+        }
+    };
+
+    for (int i = 0; i < scope.blockSize1; ++i)
+        add (ring[(size_t) (scope.startIndex1 + i)]);
+
+    for (int i = 0; i < scope.blockSize2; ++i)
+        add (ring[(size_t) (scope.startIndex2 + i)]);
+
+    return drainIntervalMs;
+}
+
+void ProcessProfiler::updateCycleRate()
+{
+   #if JUCE_INTEL
+    // Measured against the wall clock over the whole time the profiler has
+    // been running, so it gets steadily more precise.
+    auto elapsed = juce::Time::getMillisecondCounterHiRes() * 0.001 - firstSeconds;
+
+    if (elapsed > 0.01)
+        cyclesPerSecond = (double) (readCycleCounter() - firstCycles) / elapsed;
+    else if (cyclesPerSecond <= 0.0)
+        cyclesPerSecond = juce::SystemStats::getCpuSpeedInMegahertz() * 1.0e6;
+   #else
+    cyclesPerSecond = (double) juce::Time::getHighResolutionTicksPerSecond();
+   #endif
+
+    if (cyclesPerSecond <= 0.0)
+        cyclesPerSecond = 1.0e9;
+}
+
+//==============================================================================
+double ProcessProfiler::getDurationForBucket (int bucket) noexcept
+{
+    // The top of the bucket, so the percentiles err on the slow side.
+    return std::pow (10.0, (bucket + 1) / 10.0);
+}
+
+double ProcessProfiler::getLoadForBucket (int bucket) noexcept
+{
+    return (bucket + 1) * 0.005;
+}
+
+double ProcessProfiler::getPercentile (const juce::int64* buckets, int numBuckets, juce::int64 count,
+                                       double fraction, double (*bucketValue) (int)) noexcept
+{
+    if (count <= 0)
+        return 0.0;
+
+    auto target = (juce::int64) std::ceil (fraction * (double) count);
+    juce::int64 total = 0;
+
+    for (int i = 0; i < numBuckets; ++i)
+    {
+        total += buckets[i];
+
+        if (total >= target)
+            return bucketValue (i);
+    }
+
+    return bucketValue (numBuckets - 1);
+}
+
+ProcessProfiler::Statistics ProcessProfiler::getStatistics() const
+{
+    const juce::ScopedLock sl (histogramLock);
+
+    Statistics stats;
+    stats.droppedEvents = dropped.load();
+    stats.cyclesPerSecond = cyclesPerSecond;
+
+    for (size_t i = 0; i < histograms.size(); ++i)
+    {
+        auto& h = histograms[i];
+
+        StageStatistics stage;
+        stage.name   = names[(int) i];
+        stage.count  = h.count;
+        stage.p50Ns  = getPercentile (h.durations.data(), Histogram::numDurationBuckets, h.count, 0.5,   getDurationForBucket);
+        stage.p99Ns  = getPercentile (h.durations.data(), Histogram::numDurationBuckets, h.count, 0.99,  getDurationForBucket);
+        stage.p999Ns = getPercentile (h.durations.data(), Histogram::numDurationBuckets, h.count, 0.999, getDurationForBucket);
+        stage.maxNs  = h.maxNs;
+        stats.stages.push_back (stage);
+    }
+
+    auto& blocks = histograms.front();
+    auto numBlocks = std::accumulate (blocks.loads.begin(), blocks.loads.end(), (juce::int64) 0);
+
+    stats.p50Load  = getPercentile (blocks.loads.data(), Histogram::numLoadBuckets, numBlocks, 0.5,   getLoadForBucket);
+    stats.p99Load  = getPercentile (blocks.loads.data(), Histogram::numLoadBuckets, numBlocks, 0.99,  getLoadForBucket);
+    stats.p999Load = getPercentile (blocks.loads.data(), Histogram::numLoadBuckets, numBlocks, 0.999, getLoadForBucket);
+    stats.maxLoad  = blocks.maxLoad;
+
+    return stats;
+}
+
+juce::String ProcessProfiler::getSummary() const
+{
+    auto stats = getStatistics();
+
+    auto formatNs = [] (double ns) { return (ns >= 1.0e3 ? juce::String (ns * 1.0e-3, 1) + " us" : juce::String (ns, 0) + " ns").paddedLeft (' ', 10); };
+    auto formatLoad = [] (double load) { return juce::String (100.0 * load, 1) + "%"; };
+
+    juce::String text;
+    text << "stage".paddedRight (' ', 14) << "count".paddedLeft (' ', 10)
+         << "p50".paddedLeft (' ', 10) << "p99".paddedLeft (' ', 10) << "p99.9".paddedLeft (' ', 10) << "max".paddedLeft (' ', 10) << "\n";
+
+    for (auto& stage : stats.stages)
+        text << stage.name.paddedRight (' ', 14) << juce::String (stage.count).paddedLeft (' ', 10)
+             << formatNs (stage.p50Ns) << formatNs (stage.p99Ns) << formatNs (stage.p999Ns) << formatNs (stage.maxNs) << "\n";
+
+    text << "\nblock vs deadline: p50 " << formatLoad (stats.p50Load) << ", p99 " << formatLoad (stats.p99Load)
+         << ", p99.9 " << formatLoad (stats.p999Load) << ", max " << formatLoad (stats.maxLoad)
+         << "\ndropped events: " << stats.droppedEvents;
+
+    return text;
+}
+
+bool ProcessProfiler::writeToFile (const juce::File& file) const
+{
+    auto stats = getStatistics();
+
+    auto* root = new juce::DynamicObject();
+    root->setProperty ("time", juce::Time::getCurrentTime().toISO8601 (true));
+    root->setProperty ("cpu", juce::SystemStats::getCpuModel());
+    root->setProperty ("cyclesPerSecond", stats.cyclesPerSecond);
+    root->setProperty ("sampleRate", currentSampleRate.load());
+    root->setProperty ("droppedEvents", stats.droppedEvents);
+    root->setProperty ("p50Load", stats.p50Load);
+    root->setProperty ("p99Load", stats.p99Load);
+    root->setProperty ("p999Load", stats.p999Load);
+    root->setProperty ("maxLoad", stats.maxLoad);
+
+    juce::Array<juce::var> stages;
+
+    {
+        const juce::ScopedLock sl (histogramLock);
+
+        for (size_t i = 0; i < stats.stages.size(); ++i)
+        {
+            auto& s = stats.stages[i];
+            auto* o = new juce::DynamicObject();
+            o->setProperty ("name", s.name);
+            o->setProperty ("count", s.count);
+            o->setProperty ("p50Ns", s.p50Ns);
+            o->setProperty ("p99Ns", s.p99Ns);
+            o->setProperty ("p999Ns", s.p999Ns);
+            o->setProperty ("maxNs", s.maxNs);
+
+            // Bucket i counts durations from 10^(i/10) ns up to the next bucket.
+            juce::Array<juce::var> buckets;
+
+            for (auto count : histograms[i].durations)
+                buckets.add (count);
+
+            o->setProperty ("durationBuckets", buckets);
+            stages.add (juce::var (o));
+        }
+    }
+
+    root->setProperty ("stages", stages);
+
+    return file.replaceWithText (juce::JSON::toString (juce::var (root)));
+}
+
+void ProcessProfiler::reset()
+{
+    const juce::ScopedLock sl (histogramLock);
+
+    for (auto& h : histograms)
+        h = {};
+
+    dropped = 0;
+}
+
+//==============================================================================
+ProcessProfilerComponent::ProcessProfilerComponent (ProcessProfiler& profilerToShow)
+    : profiler (profilerToShow)
+{
+    addAndMakeVisible (saveButton);
+    addAndMakeVisible (resetButton);
+
+    saveButton.onClick = [this]
+    {
+        chooser = std::make_unique<juce::FileChooser> ("Save the profile", juce::File(), "*.json");
+
+        chooser->launchAsync (juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::warnAboutOverwriting,
+                              [this] (const juce::FileChooser& fc)
+                              {
+                                  if (fc.getResult() != juce::File())
+                                      profiler.writeToFile (fc.getResult());
+                              });
+    };
+
+    resetButton.onClick = [this] { profiler.reset(); };
+
+    startTimerHz (2);
+}
+
+void ProcessProfilerComponent::paint (juce::Graphics& g)
+{
+    g.fillAll (juce::Colours::black);
+    g.setColour (juce::Colours::lightgreen);
+    g.setFont (juce::Font (juce::Font::getDefaultMonospacedFontName(), 12.0f, juce::Font::plain));
+    g.drawMultiLineText (summary, 4, 14, getWidth() - 90);
+}
+
+void ProcessProfilerComponent::resized()
+{
+    auto buttons = getLocalBounds().removeFromRight (80).reduced (4);
+    saveButton.setBounds (buttons.removeFromTop (24));
+    buttons.removeFromTop (4);
+    resetButton.setBounds (buttons.removeFromTop (24));
+}
+
+void ProcessProfilerComponent::timerCallback()
+{
+    summary = profiler.getSummary();
+    repaint();
+}
+
+#endif
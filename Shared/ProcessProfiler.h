@@ -0,0 +1,237 @@
+/*
+  ==============================================================================
+
+    ProcessProfiler.h
+    Opt-in, real-time-safe timing of processBlock and its stages.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Set PROCESS_PROFILER_ENABLED=1 in a project's preprocessor definitions to
+    build the profiler in. Without it the macros below expand to nothing and
+    none of the classes exist, so a normal build carries no trace of it.
+
+    In a processor:
+
+        PROCESS_PROFILER_MEMBER (profiler, { "processBlock", "filters" })
+
+        void processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer&) override
+        {
+            PROCESS_PROFILE_BLOCK (profiler, buffer.getNumSamples());
+            ...
+            {
+                PROCESS_PROFILE_STAGE (profiler, 1);
+                ...
+            }
+        }
+
+    Stage 0 is always the whole block, and is the one measured against the
+    buffer's deadline. Call PROCESS_PROFILER_PREPARE (profiler, sampleRate)
+    from prepareToPlay().
+*/
+#ifndef PROCESS_PROFILER_ENABLED
+ #define PROCESS_PROFILER_ENABLED 0
+#endif
+
+#if PROCESS_PROFILER_ENABLED
+ #define PROCESS_PROFILER_MEMBER(name, ...)          ProcessProfiler name { __VA_ARGS__ };
+ #define PROCESS_PROFILER_PREPARE(profiler, rate)    (profiler).prepare (rate)
+ #define PROCESS_PROFILE_BLOCK(profiler, numSamples) const ProcessProfiler::Scope JUCE_JOIN_MACRO (profileScope_, __LINE__) ((profiler), 0, (numSamples))
+ #define PROCESS_PROFILE_STAGE(profiler, stage)      const ProcessProfiler::Scope JUCE_JOIN_MACRO (profileScope_, __LINE__) ((profiler), (stage), 0)
+#else
+ #define PROCESS_PROFILER_MEMBER(name, ...)
+ #define PROCESS_PROFILER_PREPARE(profiler, rate)
+ #define PROCESS_PROFILE_BLOCK(profiler, numSamples)
+ #define PROCESS_PROFILE_STAGE(profiler, stage)
+#endif
+
+#if PROCESS_PROFILER_ENABLED
+
+#if JUCE_INTEL
+ #if JUCE_MSVC
+  #include <intrin.h>
+ #else
+  #include <x86intrin.h>
+ #endif
+#endif
+
+//==============================================================================
+/**
+    Times processBlock and named stages within it.
+
+    The audio thread reads the CPU's cycle counter at the start and end of each
+    scope and pushes the pair into a wait-free single-producer ring; that is
+    all it does. If the ring is full the event is counted as dropped rather
+    than waited for.
+
+    A background thread, shared by every profiler in the process, drains the
+    ring a few times a second into a histogram per stage, with buckets a tenth
+    of a decade wide, from which the p50, p99, p99.9 and worst durations are
+    read. Whole blocks are also binned by the fraction of their deadline
+    (numSamples / sampleRate) that they used.
+*/
+class ProcessProfiler  : private juce::TimeSliceClient
+{
+public:
+    //==============================================================================
+    explicit ProcessProfiler (juce::StringArray stageNames);
+    ~ProcessProfiler() override;
+
+    /** Sets the sample rate used to work out each block's deadline. */
+    void prepare (double sampleRate) noexcept      { currentSampleRate.store (sampleRate); }
+
+    //==============================================================================
+    /** Times the enclosing scope on the audio thread. */
+    class Scope
+    {
+    public:
+        Scope (ProcessProfiler& p, int stageIndex, int numSamplesInBlock) noexcept
+            : profiler (p), stage (stageIndex), numSamples (numSamplesInBlock), start (readCycleCounter())
+        {
+        }
+
+        ~Scope() noexcept          { profiler.push ({ start, readCycleCounter(), stage, numSamples }); }
+
+    private:
+        ProcessProfiler& profiler;
+        int stage, numSamples;
+        juce::uint64 start;
+
+        JUCE_DECLARE_NON_COPYABLE (Scope)
+    };
+
+    //==============================================================================
+    struct StageStatistics
+    {
+        juce::String name;
+        juce::int64 count = 0;
+        double p50Ns = 0.0, p99Ns = 0.0, p999Ns = 0.0, maxNs = 0.0;
+    };
+
+    struct Statistics
+    {
+        std::vector<StageStatistics> stages;
+
+        /** Whole blocks, as a fraction of their deadline. */
+        double p50Load = 0.0, p99Load = 0.0, p999Load = 0.0, maxLoad = 0.0;
+
+        juce::int64 droppedEvents = 0;
+        double cyclesPerSecond = 0.0;
+    };
+
+    /** A snapshot of everything measured so far. Safe to call from any thread but the audio one. */
+    Statistics getStatistics() const;
+
+    /** The statistics as a few lines of text, for display. */
+    juce::String getSummary() const;
+
+    /** Writes the statistics and the raw histograms as JSON. */
+    bool writeToFile (const juce::File& file) const;
+
+    /** Forgets everything measured so far. */
+    void reset();
+
+    //==============================================================================
+    /** The CPU's time-stamp counter, or the high resolution tick counter where there isn't one. */
+    static juce::uint64 readCycleCounter() noexcept
+    {
+       #if JUCE_INTEL
+        return (juce::uint64) __rdtsc();
+       #else
+        return (juce::uint64) juce::Time::getHighResolutionTicks();
+       #endif
+    }
+
+private:
+    //==============================================================================
+    struct Event
+    {
+        juce::uint64 start, end;
+        int stage, numSamples;
+    };
+
+    struct Histogram
+    {
+        // Durations from 1 ns to 1 s, ten buckets per decade; loads from 0 to
+        // 200% of the deadline in steps of 0.5%. The last bucket catches the rest.
+        static constexpr int numDurationBuckets = 91, numLoadBuckets = 401;
+
+        std::array<juce::int64, numDurationBuckets> durations {};
+        std::array<juce::int64, numLoadBuckets> loads {};
+        juce::int64 count = 0;
+        double maxNs = 0.0, maxLoad = 0.0;
+    };
+
+    struct ProfilerThread  : public juce::TimeSliceThread
+    {
+        ProfilerThread()  : juce::TimeSliceThread ("Process Profiler")   { startThread (juce::Thread::Priority::low); }
+        ~ProfilerThread() override                                      { stopThread (1000); }
+    };
+
+    void push (const Event& event) noexcept;
+    int useTimeSlice() override;
+    void updateCycleRate();
+
+    static double getDurationForBucket (int bucket) noexcept;
+    static double getLoadForBucket (int bucket) noexcept;
+    static double getPercentile (const juce::int64* buckets, int numBuckets, juce::int64 count,
+                                 double fraction, double (*bucketValue) (int)) noexcept;
+
+    //==============================================================================
+    static constexpr int ringSize = 8192;
+    static constexpr int drainIntervalMs = 100;
+
+    juce::StringArray names;
+
+    juce::AbstractFifo fifo { ringSize };
+    std::vector<Event> ring;
+    std::atomic<juce::int64> dropped { 0 };
+    std::atomic<double> currentSampleRate { 0.0 };
+
+    // Guards the histograms against readers on other threads. The audio thread never takes it.
+    juce::CriticalSection histogramLock;
+    std::vector<Histogram> histograms;
+
+    // For converting cycles to time: the counter and the clock when the
+    // profiler started, and the rate measured between then and the last drain.
+    juce::uint64 firstCycles = 0;
+    double firstSeconds = 0.0, cyclesPerSecond = 0.0;
+
+    juce::SharedResourcePointer<ProfilerThread> profilerThread;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProcessProfiler)
+};
+
+//==============================================================================
+/**
+    Shows a profiler's statistics, refreshed twice a second, with a button to
+    save them as JSON.
+*/
+class ProcessProfilerComponent  : public juce::Component,
+                                  private juce::Timer
+{
+public:
+    explicit ProcessProfilerComponent (ProcessProfiler& profilerToShow);
+
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    void timerCallback() override;
+
+    ProcessProfiler& profiler;
+    juce::String summary;
+    juce::TextButton saveButton { "Save..." }, resetButton { "Reset" };
+    std::unique_ptr<juce::FileChooser> chooser;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ProcessProfilerComponent)
+};
+
+#endif
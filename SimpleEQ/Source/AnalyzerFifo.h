@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    AnalyzerFifo.h
+    Wait-free hand-over of audio from the audio thread to the analyzer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    A single-producer / single-consumer FIFO of audio for the spectrum analyzer.
+
+    The audio thread copies each block in with push(), which is a plain copy
+    per channel and never blocks or allocates. If the analyzer has fallen
+    behind, whatever doesn't fit is dropped - a gap in what the analyzer sees
+    is harmless, a late audio callback is not.
+
+    Pushing does nothing at all until setActive (true) is called, so the
+    analyzer only costs anything while an editor is open to show it.
+
+    At most the first maxChannels channels are kept, and the analyzer is given
+    their average.
+*/
+class AnalyzerFifo
+{
+public:
+    static constexpr int maxChannels = 2;
+
+    //==============================================================================
+    AnalyzerFifo() = default;
+
+    /** Allocates room for the given number of samples and empties the FIFO.
+        Must not be called concurrently with push().
+    */
+    void prepare (int numChannels, int capacity)
+    {
+        const juce::ScopedLock sl (consumerLock);
+
+        buffer.setSize (juce::jlimit (1, maxChannels, numChannels), capacity + 1);
+        buffer.clear();
+        fifo.setTotalSize (capacity + 1);
+        fifo.reset();
+    }
+
+    /** Starts or stops the audio thread pushing anything. */
+    void setActive (bool shouldBeActive) noexcept       { active.store (shouldBeActive, std::memory_order_release); }
+
+    /** The number of channels the FIFO holds. */
+    int getNumChannels() const noexcept                 { return buffer.getNumChannels(); }
+
+    //==============================================================================
+    /** Audio thread: copies in as much of the block as there is room for. */
+    template <typename SampleType>
+    void push (const juce::AudioBuffer<SampleType>& source, int numChannels) noexcept
+    {
+        if (! active.load (std::memory_order_acquire))
+            return;
+
+        const auto scope = fifo.write (juce::jmin (source.getNumSamples(), fifo.getFreeSpace()));
+        auto channels = juce::jmin (numChannels, source.getNumChannels(), buffer.getNumChannels());
+
+        for (int ch = 0; ch < channels; ++ch)
+        {
+            auto* samples = source.getReadPointer (ch);
+
+            copy (samples,                    buffer.getWritePointer (ch, scope.startIndex1), scope.blockSize1);
+            copy (samples + scope.blockSize1, buffer.getWritePointer (ch, scope.startIndex2), scope.blockSize2);
+        }
+
+        // Channels the block doesn't have are silent rather than stale.
+        for (int ch = channels; ch < buffer.getNumChannels(); ++ch)
+        {
+            buffer.clear (ch, scope.startIndex1, scope.blockSize1);
+            buffer.clear (ch, scope.startIndex2, scope.blockSize2);
+        }
+    }
+
+    //==============================================================================
+    /** Analyzer thread: moves up to the given number of samples into dest,
+        averaging the channels. Returns how many it moved.
+    */
+    int pull (float* dest, int maxSamples)
+    {
+        const juce::ScopedLock sl (consumerLock);
+
+        const auto scope = fifo.read (juce::jmin (maxSamples, fifo.getNumReady()));
+
+        for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+        {
+            mix (buffer.getReadPointer (ch, scope.startIndex1), dest,                    scope.blockSize1, ch == 0);
+            mix (buffer.getReadPointer (ch, scope.startIndex2), dest + scope.blockSize1, scope.blockSize2, ch == 0);
+        }
+
+        auto numRead = scope.blockSize1 + scope.blockSize2;
+
+        if (buffer.getNumChannels() > 1)
+            juce::FloatVectorOperations::multiply (dest, 1.0f / (float) buffer.getNumChannels(), numRead);
+
+        return numRead;
+    }
+
+private:
+    //==============================================================================
+    template <typename SampleType>
+    static void copy (const SampleType* source, float* dest, int numSamples) noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            juce::FloatVectorOperations::copy (dest, source, numSamples);
+        }
+        else
+        {
+            for (int i = 0; i < numSamples; ++i)
+                dest[i] = static_cast<float> (source[i]);
+        }
+    }
+
+    static void mix (const float* source, float* dest, int numSamples, bool replace) noexcept
+    {
+        if (replace)
+            juce::FloatVectorOperations::copy (dest, source, numSamples);
+        else
+            juce::FloatVectorOperations::add (dest, source, numSamples);
+    }
+
+    //==============================================================================
+    juce::AbstractFifo fifo { 1 };
+    juce::AudioBuffer<float> buffer;
+    std::atomic<bool> active { false };
+
+    // Keeps prepare() from resizing the buffer under the analyzer thread.
+    // The audio thread never takes it.
+    juce::CriticalSection consumerLock;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (AnalyzerFifo)
+};
@@ -0,0 +1,414 @@
+/*
+  ==============================================================================
+
+    BiquadCascade.cpp
+
+  ==============================================================================
+*/
+
+#include "BiquadCascade.h"
+
+//==============================================================================
+template <typename SampleType>
+void BiquadCascade<SampleType>::prepare (int maximumNumChannels, int crossfadeLengthInSamples, int updateIntervalInSamples)
+{
+    jassert (maximumNumChannels > 0 && crossfadeLengthInSamples >= 0 && updateIntervalInSamples > 0);
+
+    maxNumChannels = maximumNumChannels;
+    numGroups = (maxNumChannels + channelsPerGroup - 1) / channelsPerGroup;
+    fadeLength = crossfadeLengthInSamples;
+    updateInterval = updateIntervalInSamples;
+
+    // One block of memory for the state of both cascades and the two
+    // interleaved chunks, plus room to align the start of it.
+    auto stateBytes = (size_t) numGroups * sizeof (GroupState);
+    auto chunkBytes = (size_t) numGroups * (size_t) chunkSize * sizeof (SIMDType);
+
+    memory.allocate (2 * (stateBytes + chunkBytes) + SIMDType::SIMDRegisterSize, true);
+
+    auto* aligned = reinterpret_cast<char*> (SIMDType::getNextSIMDAlignedPtr (reinterpret_cast<SampleType*> (memory.get())));
+    cascades[0].state = reinterpret_cast<GroupState*> (aligned);
+    cascades[1].state = reinterpret_cast<GroupState*> (aligned + stateBytes);
+    interleaved = reinterpret_cast<SIMDType*> (aligned + 2 * stateBytes);
+    fadingOut   = reinterpret_cast<SIMDType*> (aligned + 2 * stateBytes + chunkBytes);
+    lastNumChannels = 0;
+
+    reset();
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::setTimings (int crossfadeLengthInSamples, int updateIntervalInSamples) noexcept
+{
+    jassert (crossfadeLengthInSamples >= 0 && updateIntervalInSamples > 0);
+
+    finishGlide();
+    fadeLength = crossfadeLengthInSamples;
+    fadePosition = fadeLength;
+    updateInterval = updateIntervalInSamples;
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::reset() noexcept
+{
+    for (auto& cascade : cascades)
+        clearState (cascade);
+
+    finishGlide();
+    fadePosition = fadeLength;
+    hasCoefficients = false;
+
+    if (hasPending)
+    {
+        hasPending = false;
+        setCoefficients (pending);
+    }
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::setCoefficients (const ChainCoefficients& newCoefficients) noexcept
+{
+    jassert (newCoefficients.numStages >= 0 && newCoefficients.numStages <= ChainCoefficients::maxStages);
+
+    auto& active = cascades[current];
+
+    if (! hasCoefficients)
+    {
+        // Stages that are being switched on here must not start from stale state.
+        if (newCoefficients.layout != active.layout)
+            clearState (active);
+
+        loadCoefficients (active, newCoefficients);
+        hasCoefficients = true;
+        hasPending = false;
+    }
+    else if (newCoefficients.layout == active.layout && ! newCoefficients.crossfade)
+    {
+        startGlide (newCoefficients);
+        hasPending = false;
+    }
+    else if (isFading())
+    {
+        pending = newCoefficients;
+        hasPending = true;
+    }
+    else
+    {
+        startCrossfade (newCoefficients);
+    }
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::loadStages (Stage* stages, const ChainCoefficients& newCoefficients) noexcept
+{
+    for (int i = 0; i < newCoefficients.numStages; ++i)
+    {
+        auto& c = newCoefficients.stages[(size_t) i];
+
+        stages[i].b0 = SIMDType::expand ((SampleType) c.b0);
+        stages[i].b1 = SIMDType::expand ((SampleType) c.b1);
+        stages[i].b2 = SIMDType::expand ((SampleType) c.b2);
+        stages[i].a1 = SIMDType::expand ((SampleType) c.a1);
+        stages[i].a2 = SIMDType::expand ((SampleType) c.a2);
+    }
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::loadCoefficients (Cascade& cascade, const ChainCoefficients& newCoefficients) noexcept
+{
+    // Whatever was gliding into this cascade is replaced.
+    if (&cascade == &cascades[current])
+        glideSteps = 0;
+
+    cascade.numStages = newCoefficients.numStages;
+    cascade.layout = newCoefficients.layout;
+    loadStages (cascade.stages.data(), newCoefficients);
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::startGlide (const ChainCoefficients& newCoefficients) noexcept
+{
+    auto& cascade = cascades[current];
+    auto numSteps = fadeLength / updateInterval;
+
+    if (numSteps <= 1)
+    {
+        loadCoefficients (cascade, newCoefficients);
+        return;
+    }
+
+    // Every point on the line between two stable sections is stable too (the
+    // region of stable a1, a2 is a triangle), so the glide can't blow up. A
+    // glide already under way carries on from wherever it has got to.
+    loadStages (glideTarget.data(), newCoefficients);
+
+    auto scale = SIMDType::expand ((SampleType) 1 / (SampleType) numSteps);
+
+    for (int i = 0; i < cascade.numStages; ++i)
+    {
+        auto& from = cascade.stages[(size_t) i];
+        auto& to = glideTarget[(size_t) i];
+        auto& step = glideStep[(size_t) i];
+
+        step.b0 = (to.b0 - from.b0) * scale;
+        step.b1 = (to.b1 - from.b1) * scale;
+        step.b2 = (to.b2 - from.b2) * scale;
+        step.a1 = (to.a1 - from.a1) * scale;
+        step.a2 = (to.a2 - from.a2) * scale;
+    }
+
+    // The first step is taken straight away, so the change starts on the
+    // sample it was made for.
+    glideSteps = numSteps;
+    stepGlide();
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::stepGlide() noexcept
+{
+    auto& cascade = cascades[current];
+    samplesUntilUpdate = updateInterval;
+
+    if (--glideSteps == 0)
+    {
+        // Land exactly on the target rather than wherever the rounding got to.
+        std::copy (glideTarget.begin(), glideTarget.begin() + cascade.numStages, cascade.stages.begin());
+        return;
+    }
+
+    for (int i = 0; i < cascade.numStages; ++i)
+    {
+        auto& stage = cascade.stages[(size_t) i];
+        auto& step = glideStep[(size_t) i];
+
+        stage.b0 += step.b0;
+        stage.b1 += step.b1;
+        stage.b2 += step.b2;
+        stage.a1 += step.a1;
+        stage.a2 += step.a2;
+    }
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::finishGlide() noexcept
+{
+    if (glideSteps > 0)
+    {
+        glideSteps = 1;
+        stepGlide();
+    }
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::clearState (Cascade& cascade) noexcept
+{
+    for (int g = 0; g < numGroups; ++g)
+    {
+        for (auto& z : cascade.state[g].z1)  z = SIMDType::expand (0);
+        for (auto& z : cascade.state[g].z2)  z = SIMDType::expand (0);
+    }
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::startCrossfade (const ChainCoefficients& newCoefficients) noexcept
+{
+    // The old cascade keeps running, with its state, until it has faded out.
+    // If it was gliding, it stays where it had got to.
+    glideSteps = 0;
+    current = 1 - current;
+
+    clearState (cascades[current]);
+    loadCoefficients (cascades[current], newCoefficients);
+    fadePosition = 0;
+}
+
+//==============================================================================
+template <typename SampleType>
+void BiquadCascade<SampleType>::process (juce::AudioBuffer<SampleType>& buffer, int numChannels) noexcept
+{
+    process (juce::dsp::AudioBlock<SampleType> (buffer), numChannels);
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::process (const juce::dsp::AudioBlock<SampleType>& block, int numChannels) noexcept
+{
+    jassert (interleaved != nullptr);
+    jassert (numChannels <= maxNumChannels);
+
+    numChannels = juce::jmin (numChannels, maxNumChannels, (int) block.getNumChannels());
+    auto blockLength = (int) block.getNumSamples();
+
+    // Nothing to filter: leave the buffer exactly as it is.
+    if (isNeutral() || numChannels <= 0)
+        return;
+
+    if (numChannels != lastNumChannels)
+    {
+        // Unused lanes must hold silence so they can never go denormal or NaN.
+        juce::zeromem (interleaved, (size_t) numGroups * (size_t) chunkSize * sizeof (SIMDType));
+        lastNumChannels = numChannels;
+    }
+
+    auto numActiveGroups = (numChannels + channelsPerGroup - 1) / channelsPerGroup;
+    auto* lanes = reinterpret_cast<SampleType*> (interleaved);
+
+    for (int start = 0, numSamples = 0; start < blockLength; start += numSamples)
+    {
+        numSamples = juce::jmin (chunkSize, blockLength - start);
+
+        // A glide steps between chunks, never inside one.
+        if (glideSteps > 0)
+            numSamples = juce::jmin (numSamples, samplesUntilUpdate);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* src = block.getChannelPointer ((size_t) ch) + start;
+            auto* dst = lanes + (ch / channelsPerGroup) * chunkSize * channelsPerGroup + ch % channelsPerGroup;
+
+            for (int i = 0; i < numSamples; ++i)
+                dst[i * channelsPerGroup] = src[i];
+        }
+
+        if (isFading())
+        {
+            std::copy (interleaved, interleaved + numActiveGroups * chunkSize, fadingOut);
+
+            processCascade (cascades[current], interleaved, numActiveGroups, numSamples);
+            processCascade (cascades[1 - current], fadingOut, numActiveGroups, numSamples);
+            mixCrossfade (numActiveGroups, numSamples);
+        }
+        else
+        {
+            processCascade (cascades[current], interleaved, numActiveGroups, numSamples);
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* src = lanes + (ch / channelsPerGroup) * chunkSize * channelsPerGroup + ch % channelsPerGroup;
+            auto* dst = block.getChannelPointer ((size_t) ch) + start;
+
+            for (int i = 0; i < numSamples; ++i)
+                dst[i] = src[i * channelsPerGroup];
+        }
+
+        if (glideSteps > 0 && (samplesUntilUpdate -= numSamples) == 0)
+            stepGlide();
+    }
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::mixCrossfade (int numActiveGroups, int numSamples) noexcept
+{
+    auto fadeStep = (SampleType) 1 / (SampleType) fadeLength;
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto gain = SIMDType::expand (juce::jmin ((SampleType) 1, (SampleType) (fadePosition + i + 1) * fadeStep));
+
+        for (int g = 0; g < numActiveGroups; ++g)
+        {
+            auto& out = interleaved[g * chunkSize + i];
+            auto old = fadingOut[g * chunkSize + i];
+            out = old + (out - old) * gain;
+        }
+    }
+
+    fadePosition = juce::jmin (fadeLength, fadePosition + numSamples);
+
+    if (! isFading() && hasPending)
+    {
+        hasPending = false;
+        setCoefficients (pending);
+    }
+}
+
+template <typename SampleType>
+void BiquadCascade<SampleType>::processCascade (Cascade& cascade, SIMDType* data, int numActiveGroups, int numSamples) noexcept
+{
+    if (cascade.numStages == 0)
+        return;
+
+    auto g = 0;
+
+    for (; g + 1 < numActiveGroups; g += 2)
+        processGroups<2> (cascade, data, g, numSamples);
+
+    if (g < numActiveGroups)
+        processGroups<1> (cascade, data, g, numSamples);
+}
+
+template <typename SampleType>
+template <int NumGroups>
+void BiquadCascade<SampleType>::processGroups (Cascade& cascade, SIMDType* data, int firstGroup, int numSamples) noexcept
+{
+    auto* groupData = data + firstGroup * chunkSize;
+    auto* state = cascade.state + firstGroup;
+    auto* stages = cascade.stages.data();
+
+    static_assert (ChainCoefficients::maxStages == 9, "Add a case for every possible number of stages");
+
+    switch (cascade.numStages)
+    {
+        case 1:  runCascade<1, NumGroups> (stages, groupData, state, numSamples); break;
+        case 2:  runCascade<2, NumGroups> (stages, groupData, state, numSamples); break;
+        case 3:  runCascade<3, NumGroups> (stages, groupData, state, numSamples); break;
+        case 4:  runCascade<4, NumGroups> (stages, groupData, state, numSamples); break;
+        case 5:  runCascade<5, NumGroups> (stages, groupData, state, numSamples); break;
+        case 6:  runCascade<6, NumGroups> (stages, groupData, state, numSamples); break;
+        case 7:  runCascade<7, NumGroups> (stages, groupData, state, numSamples); break;
+        case 8:  runCascade<8, NumGroups> (stages, groupData, state, numSamples); break;
+        case 9:  runCascade<9, NumGroups> (stages, groupData, state, numSamples); break;
+        default: jassertfalse; break;
+    }
+}
+
+template <typename SampleType>
+template <int NumStages, int NumGroups>
+void BiquadCascade<SampleType>::runCascade (const Stage* stages, SIMDType* data, GroupState* state, int numSamples) noexcept
+{
+    // Copy everything into locals so that the compiler can keep the cascade in
+    // registers for the duration of the chunk.
+    Stage c[NumStages];
+    SIMDType z1[NumGroups][NumStages], z2[NumGroups][NumStages];
+
+    for (int s = 0; s < NumStages; ++s)
+    {
+        c[s] = stages[s];
+
+        for (int g = 0; g < NumGroups; ++g)
+        {
+            z1[g][s] = state[g].z1[s];
+            z2[g][s] = state[g].z2[s];
+        }
+    }
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        for (int g = 0; g < NumGroups; ++g)
+        {
+            auto x = data[g * chunkSize + i];
+
+            for (int s = 0; s < NumStages; ++s)
+            {
+                auto y   = c[s].b0 * x + z1[g][s];
+                z1[g][s] = c[s].b1 * x - c[s].a1 * y + z2[g][s];
+                z2[g][s] = c[s].b2 * x - c[s].a2 * y;
+                x = y;
+            }
+
+            data[g * chunkSize + i] = x;
+        }
+    }
+
+    for (int s = 0; s < NumStages; ++s)
+    {
+        for (int g = 0; g < NumGroups; ++g)
+        {
+            state[g].z1[s] = z1[g][s];
+            state[g].z2[s] = z2[g][s];
+        }
+    }
+}
+
+//==============================================================================
+template class BiquadCascade<float>;
+template class BiquadCascade<double>;
@@ -0,0 +1,166 @@
+/*
+  ==============================================================================
+
+    BiquadCascade.h
+    The whole filter chain as one biquad cascade, vectorised across channels.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FilterDesign.h"
+
+//==============================================================================
+/**
+    Runs up to ChainCoefficients::maxStages transposed-direct-form-II biquads
+    over a block in a single pass.
+
+    LowCut, Peak and HighCut aren't separate filters here: their sections are
+    strung together into one cascade, and each sample goes through all of them
+    before the next is loaded. The buffer is read and written once per block
+    however many bands are active, so memory traffic stays flat as bands are
+    added and only the arithmetic grows. The recursion state lives in locals
+    for the whole chunk, which lets the compiler keep as much of it in
+    registers as the target has room for.
+
+    Rather than filtering each channel in turn, the channels are interleaved into
+    the lanes of a juce::dsp::SIMDRegister so that one SIMD instruction advances
+    a whole group of channels at once - a stereo chain costs about the same as
+    a single scalar channel would.
+
+    Layouts wider than one register are split into groups of channelsPerGroup
+    channels, and the filter state is kept per group, one lane per channel.
+    Groups are run two at a time so that their independent recursions overlap
+    in the pipeline, which makes each extra channel cheaper than the last.
+
+    Blocks are processed in chunks of chunkSize samples so that the interleaved
+    copy stays in L1 cache whatever the host's block size.
+
+    A cascade with no stages is neutral and process() leaves the buffer alone,
+    so an idle instance costs next to nothing. When sections are switched in
+    or out, the outgoing and incoming cascades run side by side for a short
+    crossfade so that the change doesn't click. New coefficients for the same
+    sections are glided to instead, in a straight line over the length of a
+    crossfade, one step every updateInterval samples. Between steps the
+    coefficients stay put, so the inner loop never changes.
+
+    SampleType is float or double. Both share this implementation; with double
+    each register holds half as many channels, but the cascade keeps full
+    precision, which matters for low cutoffs at high sample rates where the
+    poles sit very close to the unit circle.
+*/
+template <typename SampleType>
+class BiquadCascade
+{
+public:
+    using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+
+    /** The number of channels that fit into one register on this platform. */
+    static constexpr int channelsPerGroup = (int) SIMDType::SIMDNumElements;
+
+    /** The number of samples interleaved and filtered at a time. */
+    static constexpr int chunkSize = 256;
+
+    //==============================================================================
+    BiquadCascade() = default;
+
+    /** Allocates the state and scratch space for up to the given number of
+        channels, and sets how long a change in the sections in use takes to
+        fade in and how often a glide between coefficients takes a step.
+        Call before processing.
+    */
+    void prepare (int maximumNumChannels, int crossfadeLengthInSamples, int updateIntervalInSamples);
+
+    /** Changes how long crossfades take and how often glides step, for when
+        the rate the cascade runs at changes. Any crossfade or glide in
+        progress is finished.
+    */
+    void setTimings (int crossfadeLengthInSamples, int updateIntervalInSamples) noexcept;
+
+    /** Clears the filter state and finishes any crossfade or glide. The next
+        call to setCoefficients() takes effect straight away.
+    */
+    void reset() noexcept;
+
+    /** Swaps in a new set of coefficients.
+
+        If the same sections are in use the filter state is kept, and the
+        coefficients glide to the new ones, starting with the next sample.
+        Otherwise, or if the coefficients ask for a crossfade, the new cascade
+        starts from silence and is crossfaded in; a further change that
+        arrives mid-fade is held back until the fade has finished.
+    */
+    void setCoefficients (const ChainCoefficients& newCoefficients) noexcept;
+
+    /** True if process() currently has nothing to do. */
+    bool isNeutral() const noexcept     { return ! isFading() && cascades[current].numStages == 0; }
+
+    /** Filters the first numChannels channels of the buffer in place. */
+    void process (juce::AudioBuffer<SampleType>& buffer, int numChannels) noexcept;
+
+    /** Filters the first numChannels channels of the block in place. */
+    void process (const juce::dsp::AudioBlock<SampleType>& block, int numChannels) noexcept;
+
+private:
+    //==============================================================================
+    struct Stage
+    {
+        SIMDType b0, b1, b2, a1, a2;
+    };
+
+    struct GroupState
+    {
+        SIMDType z1[ChainCoefficients::maxStages], z2[ChainCoefficients::maxStages];
+    };
+
+    struct Cascade
+    {
+        std::array<Stage, ChainCoefficients::maxStages> stages;
+        int numStages = 0, layout = 0;
+        GroupState* state = nullptr;    // [numGroups]
+    };
+
+    bool isFading() const noexcept      { return fadePosition < fadeLength; }
+
+    static void loadStages (Stage* stages, const ChainCoefficients& newCoefficients) noexcept;
+    void loadCoefficients (Cascade& cascade, const ChainCoefficients& newCoefficients) noexcept;
+    void startGlide (const ChainCoefficients& newCoefficients) noexcept;
+    void stepGlide() noexcept;
+    void finishGlide() noexcept;
+    void clearState (Cascade& cascade) noexcept;
+    void startCrossfade (const ChainCoefficients& newCoefficients) noexcept;
+    void mixCrossfade (int numActiveGroups, int numSamples) noexcept;
+
+    void processCascade (Cascade& cascade, SIMDType* data, int numActiveGroups, int numSamples) noexcept;
+
+    template <int NumGroups>
+    void processGroups (Cascade& cascade, SIMDType* data, int firstGroup, int numSamples) noexcept;
+
+    template <int NumStages, int NumGroups>
+    void runCascade (const Stage* stages, SIMDType* data, GroupState* state, int numSamples) noexcept;
+
+    // cascades[current] is the one in use; while fading, the other one is
+    // still running and being faded out.
+    Cascade cascades[2];
+    int current = 0;
+    int fadeLength = 0, fadePosition = 0;
+    bool hasCoefficients = false;
+
+    // A change of layout that arrived during a crossfade.
+    ChainCoefficients pending;
+    bool hasPending = false;
+
+    // While glideSteps > 0, cascades[current] is gliding towards glideTarget,
+    // adding glideStep every updateInterval samples.
+    std::array<Stage, ChainCoefficients::maxStages> glideTarget, glideStep;
+    int glideSteps = 0, updateInterval = 64, samplesUntilUpdate = 0;
+
+    juce::HeapBlock<char> memory;
+    SIMDType* interleaved = nullptr;    // [numGroups][chunkSize]
+    SIMDType* fadingOut = nullptr;      // [numGroups][chunkSize], the outgoing cascade's copy
+    int numGroups = 0, maxNumChannels = 0, lastNumChannels = 0;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (BiquadCascade)
+};
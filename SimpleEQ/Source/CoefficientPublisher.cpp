@@ -0,0 +1,204 @@
+/*
+  ==============================================================================
+
+    CoefficientPublisher.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientPublisher.h"
+
+//==============================================================================
+CoefficientPublisher::CoefficientPublisher (juce::AudioProcessorValueTreeState& state)
+    : parameters (state)
+{
+    for (size_t i = 0; i < controllableParameters.size(); ++i)
+    {
+        controllableParameters[i] = state.getParameter (ParameterSnapshot::parameterIDs[i]);
+        jassert (controllableParameters[i] != nullptr);
+
+        pendingControllerValues[i] = -1.0f;
+    }
+
+    designThread->addTimeSliceClient (this);
+}
+
+CoefficientPublisher::~CoefficientPublisher()
+{
+    // Blocks until the design thread has finished with us.
+    designThread->removeTimeSliceClient (this);
+}
+
+//==============================================================================
+void CoefficientPublisher::prepare (double sampleRate)
+{
+    jassert (sampleRate > 0.0);
+
+    const juce::ScopedLock sl (writerLock);
+
+    currentSampleRate = sampleRate;
+
+    // Everything is designed for the new rate.
+    designAndPublish (parameters.update().getFilterSettings(), ParameterSnapshot::allParameters);
+}
+
+void CoefficientPublisher::applyChange (const std::function<void()>& changeParameters)
+{
+    const juce::ScopedLock sl (writerLock);
+
+    changeParameters();
+
+    // Before prepare() there's nothing to design for; the first prepare()
+    // picks the new values up.
+    if (currentSampleRate > 0.0)
+    {
+        auto& snapshot = parameters.update();
+        designAndPublish (snapshot.getFilterSettings(), snapshot.changed, true);
+    }
+}
+
+void CoefficientPublisher::setUseCoefficientTable (bool shouldUseTable)
+{
+    const juce::ScopedLock sl (writerLock);
+
+    useTable = shouldUseTable;
+    updateTable();
+}
+
+void CoefficientPublisher::updateTable()
+{
+    if (useTable && designSampleRate > 0.0)
+    {
+        if (table == nullptr || ! juce::approximatelyEqual (table->getSampleRate(), designSampleRate))
+            table = tableCache->getTable (designSampleRate);
+    }
+    else
+    {
+        table.reset();
+    }
+}
+
+const ChainCoefficients* CoefficientPublisher::pullNewCoefficients() noexcept
+{
+    return coefficients.pull() ? &coefficients.getReadBuffer() : nullptr;
+}
+
+void CoefficientPublisher::applyControllerChange (FilterSettings& settings, int slot, float normalisedValue) noexcept
+{
+    if (! juce::isPositiveAndBelow (slot, numControllableParameters))
+        return;
+
+    auto& range = controllableParameters[(size_t) slot]->getNormalisableRange();
+    auto value = range.snapToLegalValue (range.convertFrom0to1 (normalisedValue));
+
+    switch (slot)
+    {
+        case 0:  settings.lowCutFreq = value;                                   break;
+        case 1:  settings.lowCutSlope = static_cast<Slope> (juce::roundToInt (value));  break;
+        case 2:  settings.peakFreq = value;                                     break;
+        case 3:  settings.peakGainInDecibels = value;                           break;
+        case 4:  settings.peakQuality = value;                                  break;
+        case 5:  settings.highCutFreq = value;                                  break;
+        case 6:  settings.highCutSlope = static_cast<Slope> (juce::roundToInt (value)); break;
+        default: break;
+    }
+
+    pendingControllerValues[(size_t) slot].store (normalisedValue, std::memory_order_relaxed);
+    controllerSequence.fetch_add (1, std::memory_order_release);
+}
+
+//==============================================================================
+int CoefficientPublisher::useTimeSlice()
+{
+    const juce::ScopedLock sl (writerLock);
+
+    auto controllersMoved = controllerSequence.load (std::memory_order_acquire) != appliedControllerSequence;
+
+    if (controllersMoved)
+        applyPendingControllerChanges();
+
+    if (currentSampleRate > 0.0)
+    {
+        auto& snapshot = parameters.update();
+
+        // After controller changes it's published even if nothing has
+        // changed, so that the audio thread knows the parameters have caught
+        // up with them.
+        if (controllersMoved || snapshot.hasChanged (ParameterSnapshot::lowCutBand | ParameterSnapshot::peakBand
+                                                      | ParameterSnapshot::highCutBand))
+            designAndPublish (snapshot.getFilterSettings(), snapshot.changed);
+    }
+
+    return pollIntervalMs;
+}
+
+void CoefficientPublisher::applyPendingControllerChanges()
+{
+    appliedControllerSequence = controllerSequence.load (std::memory_order_acquire);
+
+    for (size_t i = 0; i < controllableParameters.size(); ++i)
+    {
+        auto value = pendingControllerValues[i].exchange (-1.0f, std::memory_order_relaxed);
+
+        if (value >= 0.0f)
+            controllableParameters[i]->setValueNotifyingHost (value);
+    }
+}
+
+FilterSettings CoefficientPublisher::readSettings() const noexcept
+{
+    return parameters.read().getFilterSettings();
+}
+
+void CoefficientPublisher::designBands (const FilterSettings& settings, double sampleRate, const CutCoefficientTable* table,
+                                        juce::uint32 changed, BandCoefficients& result) noexcept
+{
+    // The table turns on-grid settings into a copy; anything else gets designed.
+    // In linear-phase mode the LowCut is left to LinearPhaseLowCut.
+    if ((changed & ParameterSnapshot::lowCutBand) != 0)
+    {
+        result.lowCut = {};
+
+        if (! settings.linearPhaseLowCut && ! isLowCutBypassed (settings)
+             && (table == nullptr || ! table->lookupLowCut (settings.lowCutFreq, settings.lowCutSlope, result.lowCut)))
+            result.lowCut = makeLowCutCoefficients (settings.lowCutFreq, sampleRate, settings.lowCutSlope);
+    }
+
+    if ((changed & ParameterSnapshot::highCutBand) != 0)
+    {
+        result.highCut = {};
+
+        if (! isHighCutBypassed (settings)
+             && (table == nullptr || ! table->lookupHighCut (settings.highCutFreq, settings.highCutSlope, result.highCut)))
+            result.highCut = makeHighCutCoefficients (settings.highCutFreq, sampleRate, settings.highCutSlope);
+    }
+
+    if ((changed & ParameterSnapshot::peakBand) != 0)
+        result.peak = makePeakCoefficients (settings.peakFreq, settings.peakGainInDecibels, settings.peakQuality, sampleRate);
+}
+
+ChainCoefficients CoefficientPublisher::makeChain (const BandCoefficients& bandCoefficients, const FilterSettings& settings) noexcept
+{
+    // Only the sections that change the signal make it into the chain, so the
+    // audio thread never runs one that does nothing.
+    auto c = makeChainCoefficients (bandCoefficients.lowCut, bandCoefficients.peak, bandCoefficients.highCut);
+    c.linearPhaseLowCut = settings.linearPhaseLowCut;
+    c.oversamplingFactor = settings.oversamplingFactor;
+    return c;
+}
+
+void CoefficientPublisher::designAndPublish (const FilterSettings& settings, juce::uint32 changed, bool crossfade)
+{
+    // Switching the oversampling factor moves to another rate's table.
+    designSampleRate = currentSampleRate * settings.oversamplingFactor;
+    updateTable();
+
+    designBands (settings, designSampleRate, table.get(), changed, bands);
+
+    auto& c = coefficients.getWriteBuffer();
+    c = makeChain (bands, settings);
+    c.crossfade = crossfade;
+    c.controllerSequence = appliedControllerSequence;
+    tailLengthSeconds = c.tailLengthSamples / designSampleRate;
+    coefficients.publish();
+}
@@ -0,0 +1,158 @@
+/*
+  ==============================================================================
+
+    CoefficientPublisher.h
+    Designs filter coefficients away from the audio thread.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FilterDesign.h"
+#include "TripleBuffer.h"
+#include "CoefficientTable.h"
+#include "ParameterSnapshot.h"
+
+//==============================================================================
+/**
+    The background thread that designs filters for every SimpleEQ instance in
+    the process. Hold it through a juce::SharedResourcePointer.
+*/
+struct FilterDesignThread  : public juce::TimeSliceThread
+{
+    FilterDesignThread()  : juce::TimeSliceThread ("SimpleEQ Coefficient Designer")   { startThread(); }
+    ~FilterDesignThread() override                                                   { stopThread (1000); }
+};
+
+//==============================================================================
+/**
+    Watches the filter parameters from a background thread and, whenever they
+    change, designs a fresh ChainCoefficients and hands it to the audio thread
+    through a TripleBuffer. Each poll takes a ParameterSnapshot, and only the
+    bands whose parameters it marks as changed are designed again; the others
+    are reused from the last time.
+
+    All the trigonometry happens on the design thread (or on the message thread
+    in prepare()), so the audio thread only ever copies ready-made plain data:
+    no locks, no allocation and no maths beyond what the filters themselves do.
+
+    Every instance in the process shares a single design thread. When the
+    coefficient table is enabled, on-grid settings are looked up in a
+    CutCoefficientTable shared by every instance instead of being designed.
+
+    MIDI controllers change the filters on the audio thread itself, at the
+    sample they arrive on. The design thread then moves the parameters to
+    match, and until it has, the audio thread ignores what's published.
+*/
+class CoefficientPublisher  : private juce::TimeSliceClient
+{
+public:
+    //==============================================================================
+    explicit CoefficientPublisher (juce::AudioProcessorValueTreeState& state);
+    ~CoefficientPublisher() override;
+
+    /** Designs coefficients for the new sample rate straight away, so that the
+        first block after this call already has them. When oversampling is on,
+        they're designed for the oversampled rate.
+        Must not be called concurrently with the audio callback.
+    */
+    void prepare (double sampleRate);
+
+    /** Makes a set of parameter changes as one step, such as loading a preset.
+
+        The design thread is held off while changeParameters() runs, so it
+        never sees the change half made, and the result is then designed
+        straight away and published with a request that the audio thread
+        crossfade to it. Call from the message thread.
+    */
+    void applyChange (const std::function<void()>& changeParameters);
+
+    /** Turns the shared lookup table on or off. It's on by default; while it is
+        still being built the coefficients are designed directly.
+    */
+    void setUseCoefficientTable (bool shouldUseTable);
+
+    /** The memory held by the coefficient tables of every instance in the process. */
+    size_t getCoefficientTableMemoryFootprint()          { return tableCache->getMemoryFootprint(); }
+
+    /** The tail of the most recently designed coefficients. Safe to call from any thread. */
+    double getTailLengthSeconds() const noexcept         { return tailLengthSeconds.load(); }
+
+    /** Audio thread: returns the newest coefficients if they have changed since
+        the last call, or nullptr if nothing new has been published.
+        The pointer stays valid until the next call.
+    */
+    const ChainCoefficients* pullNewCoefficients() noexcept;
+
+    /** The settings the parameters hold right now. Safe to call from any thread. */
+    FilterSettings readSettings() const noexcept;
+
+    /** Designs again the bands whose parameters are marked in `changed` (a
+        mask of ParameterSnapshot bits) at the given rate, which already
+        includes any oversampling, looking on-grid cuts up in the table if one
+        is given. The other bands are left as they are. It neither locks nor
+        allocates, so the audio thread can use it too.
+    */
+    static void designBands (const FilterSettings& settings, double sampleRate, const CutCoefficientTable* table,
+                             juce::uint32 changed, BandCoefficients& bands) noexcept;
+
+    /** Strings the bands together into the chain the audio thread runs. */
+    static ChainCoefficients makeChain (const BandCoefficients& bands, const FilterSettings& settings) noexcept;
+
+    //==============================================================================
+    /** The parameters that MIDI controllers can move: the first ones in
+        ParameterSnapshot, whose indices double as the slots.
+    */
+    static constexpr int numControllableParameters = ParameterSnapshot::highCutSlope + 1;
+
+    /** Audio thread: applies a controller's move of one of the controllable
+        parameters to a set of settings, and queues the parameter itself to be
+        moved to match from the design thread, as the audio thread mustn't
+        notify the host.
+    */
+    void applyControllerChange (FilterSettings& settings, int slot, float normalisedValue) noexcept;
+
+    /** Audio thread: coefficients published with this controllerSequence
+        include every change passed to applyControllerChange() so far. Anything
+        older was designed from parameters that haven't caught up yet.
+    */
+    juce::uint32 getControllerSequence() const noexcept  { return controllerSequence.load (std::memory_order_relaxed); }
+
+private:
+    //==============================================================================
+    int useTimeSlice() override;
+    void applyPendingControllerChanges();
+    void designAndPublish (const FilterSettings& settings, juce::uint32 changed, bool crossfade = false);
+    void updateTable();
+
+    //==============================================================================
+    // How often the design thread looks for parameter changes.
+    static constexpr int pollIntervalMs = 5;
+
+    // Serialises prepare() against the design thread. The audio thread never
+    // takes it. Snapshots are only taken, and the bands only designed, with
+    // it held.
+    juce::CriticalSection writerLock;
+    ParameterSnapshotReader parameters;
+    BandCoefficients bands;
+    double currentSampleRate = 0.0, designSampleRate = 0.0;
+    bool useTable = true;
+    std::shared_ptr<const CutCoefficientTable> table;
+    std::atomic<double> tailLengthSeconds { 0.0 };
+
+    TripleBuffer<ChainCoefficients> coefficients;
+
+    // Written by the audio thread, applied to the parameters by the design
+    // thread. A negative value means there's nothing waiting for that slot.
+    std::array<juce::RangedAudioParameter*, numControllableParameters> controllableParameters {};
+    std::array<std::atomic<float>, numControllableParameters> pendingControllerValues;
+    std::atomic<juce::uint32> controllerSequence { 0 };
+    juce::uint32 appliedControllerSequence = 0;
+
+    juce::SharedResourcePointer<CoefficientTableCache> tableCache;
+    juce::SharedResourcePointer<FilterDesignThread> designThread;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CoefficientPublisher)
+};
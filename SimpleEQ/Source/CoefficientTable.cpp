@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    CoefficientTable.cpp
+
+  ==============================================================================
+*/
+
+#include "CoefficientTable.h"
+
+//==============================================================================
+CutCoefficientTable::CutCoefficientTable (double rate)
+    : sampleRate (rate)
+{
+    jassert (sampleRate > 0.0);
+}
+
+int CutCoefficientTable::getSlopeOffset (Slope slope) noexcept
+{
+    auto n = (int) slope;
+    return n * (n + 1) / 2;
+}
+
+void CutCoefficientTable::build()
+{
+    jassert (! isReady());
+
+    lowCut.resize ((size_t) (numFrequencies * biquadsPerFrequency));
+    highCut.resize ((size_t) (numFrequencies * biquadsPerFrequency));
+
+    for (int f = 0; f < numFrequencies; ++f)
+    {
+        auto* lowCutRow  = lowCut.data()  + f * biquadsPerFrequency;
+        auto* highCutRow = highCut.data() + f * biquadsPerFrequency;
+
+        for (auto slope : { Slope_12, Slope_24, Slope_36, Slope_48 })
+        {
+            auto l = makeLowCutCoefficients (minFrequency + f, sampleRate, slope);
+            std::copy (l.stages.begin(), l.stages.begin() + l.numStages, lowCutRow + getSlopeOffset (slope));
+
+            auto h = makeHighCutCoefficients (minFrequency + f, sampleRate, slope);
+            std::copy (h.stages.begin(), h.stages.begin() + h.numStages, highCutRow + getSlopeOffset (slope));
+        }
+    }
+
+    ready.store (true, std::memory_order_release);
+
+    DBG ("SimpleEQ: built coefficient table for " << sampleRate << " Hz, "
+         << juce::File::descriptionOfSizeInBytes ((juce::int64) getMemoryFootprint()));
+}
+
+bool CutCoefficientTable::lookupLowCut (float frequency, Slope slope, CutFilterCoefficients& result) const noexcept
+{
+    return lookup (lowCut, frequency, slope, result);
+}
+
+bool CutCoefficientTable::lookupHighCut (float frequency, Slope slope, CutFilterCoefficients& result) const noexcept
+{
+    return lookup (highCut, frequency, slope, result);
+}
+
+bool CutCoefficientTable::lookup (const std::vector<BiquadCoefficients>& rows, float frequency, Slope slope,
+                                  CutFilterCoefficients& result) const noexcept
+{
+    if (! isReady())
+        return false;
+
+    auto index = juce::roundToInt (frequency);
+
+    if (std::abs (frequency - (float) index) > 1.0e-3f || index < minFrequency || index > maxFrequency)
+        return false;
+
+    auto* first = rows.data() + (index - minFrequency) * biquadsPerFrequency + getSlopeOffset (slope);
+
+    result.numStages = (int) slope + 1;
+    std::copy (first, first + result.numStages, result.stages.begin());
+    return true;
+}
+
+size_t CutCoefficientTable::getMemoryFootprint() const noexcept
+{
+    // Worked out from the table's dimensions rather than the vectors, which
+    // the builder thread may be resizing while this is called.
+    auto numBiquads = isReady() ? 2 * (size_t) numFrequencies * (size_t) biquadsPerFrequency : 0;
+    return sizeof (*this) + numBiquads * sizeof (BiquadCoefficients);
+}
+
+//==============================================================================
+CoefficientTableCache::CoefficientTableCache() = default;
+
+CoefficientTableCache::~CoefficientTableCache()
+{
+    builder.removeAllJobs (true, 10000);
+}
+
+std::shared_ptr<const CutCoefficientTable> CoefficientTableCache::getTable (double sampleRate)
+{
+    const juce::ScopedLock sl (lock);
+
+    tables.erase (std::remove_if (tables.begin(), tables.end(), [] (const auto& t) { return t.expired(); }),
+                  tables.end());
+
+    for (auto& t : tables)
+        if (auto table = t.lock())
+            if (juce::approximatelyEqual (table->getSampleRate(), sampleRate))
+                return table;
+
+    auto table = std::make_shared<CutCoefficientTable> (sampleRate);
+    tables.push_back (table);
+
+    // The job only holds a weak reference, so a table that nobody wants any
+    // more by the time its turn comes is simply skipped.
+    std::weak_ptr<CutCoefficientTable> toBuild (table);
+
+    builder.addJob ([toBuild]
+    {
+        if (auto t = toBuild.lock())
+            t->build();
+    });
+
+    return table;
+}
+
+size_t CoefficientTableCache::getMemoryFootprint()
+{
+    const juce::ScopedLock sl (lock);
+
+    size_t total = 0;
+
+    for (auto& t : tables)
+        if (auto table = t.lock())
+            total += table->getMemoryFootprint();
+
+    return total;
+}
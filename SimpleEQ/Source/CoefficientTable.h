@@ -0,0 +1,100 @@
+/*
+  ==============================================================================
+
+    CoefficientTable.h
+    Precomputed cut filter coefficients for every point on the parameter grid.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FilterDesign.h"
+
+//==============================================================================
+/**
+    Every LowCut and HighCut coefficient set that the parameters can ask for at
+    one sample rate.
+
+    Both cutoffs move in 1 Hz steps between 20 Hz and 20 kHz and there are only
+    four slopes, so each filter's design space is 19981 * (1 + 2 + 3 + 4) biquads.
+    Once built, a coefficient update is an array index rather than a round of
+    sin/cos calls.
+
+    The table is built on a background thread; until isReady() returns true the
+    caller should design the coefficients directly.
+*/
+class CutCoefficientTable
+{
+public:
+    //==============================================================================
+    static constexpr int minFrequency = 20, maxFrequency = 20000;
+    static constexpr int numFrequencies = maxFrequency - minFrequency + 1;
+
+    // Slope n uses n + 1 biquads, stored one after the other.
+    static constexpr int biquadsPerFrequency = 1 + 2 + 3 + 4;
+
+    explicit CutCoefficientTable (double sampleRate);
+
+    double getSampleRate() const noexcept           { return sampleRate; }
+    bool isReady() const noexcept                   { return ready.load (std::memory_order_acquire); }
+
+    /** Fills the table. Called once, from the background builder. */
+    void build();
+
+    /** Copies out the coefficients for an on-grid frequency. Returns false if the
+        table isn't ready yet or the frequency isn't one of the grid points.
+    */
+    bool lookupLowCut (float frequency, Slope slope, CutFilterCoefficients& result) const noexcept;
+
+    /** The same, for the HighCut filter. */
+    bool lookupHighCut (float frequency, Slope slope, CutFilterCoefficients& result) const noexcept;
+
+    /** The number of bytes held by this table, once it's built. Safe to call
+        from any thread.
+    */
+    size_t getMemoryFootprint() const noexcept;
+
+private:
+    //==============================================================================
+    static int getSlopeOffset (Slope slope) noexcept;
+    bool lookup (const std::vector<BiquadCoefficients>& rows, float frequency, Slope slope,
+                 CutFilterCoefficients& result) const noexcept;
+
+    const double sampleRate;
+    std::vector<BiquadCoefficients> lowCut, highCut;
+    std::atomic<bool> ready { false };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CutCoefficientTable)
+};
+
+//==============================================================================
+/**
+    Owns the tables for every sample rate in use, shared by all SimpleEQ instances
+    in the process through a juce::SharedResourcePointer.
+
+    Tables are handed out as shared_ptrs and built lazily on a low priority
+    thread the first time a sample rate is asked for. Once the last instance
+    running at a rate lets go of it, the table is freed.
+*/
+class CoefficientTableCache
+{
+public:
+    CoefficientTableCache();
+    ~CoefficientTableCache();
+
+    /** Returns the table for a sample rate, queueing it to be built if nobody
+        else is using it yet. Don't call this from the audio thread.
+    */
+    std::shared_ptr<const CutCoefficientTable> getTable (double sampleRate);
+
+    /** The total size of all the tables currently alive, in bytes. */
+    size_t getMemoryFootprint();
+
+private:
+    juce::CriticalSection lock;
+    std::vector<std::weak_ptr<CutCoefficientTable>> tables;
+    juce::ThreadPool builder { 1 };
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (CoefficientTableCache)
+};
@@ -0,0 +1,251 @@
+/*
+  ==============================================================================
+
+    FilterDesign.cpp
+
+  ==============================================================================
+*/
+
+#include "FilterDesign.h"
+#include "../../Shared/FastMath.h"
+
+//==============================================================================
+double getButterworthStageQ (int numStages, int stageIndex) noexcept
+{
+    jassert (numStages > 0 && stageIndex >= 0 && stageIndex < numStages);
+
+    // The poles of an order 2N Butterworth filter pair up into N sections,
+    // each with Q = 1 / (2 sin ((2k + 1) * pi / 4N)).
+    auto order = 2 * numStages;
+    auto angle = (2 * stageIndex + 1) * juce::MathConstants<double>::pi / (2.0 * order);
+
+    return 1.0 / (2.0 * FastMath::sin (angle));
+}
+
+static BiquadCoefficients makeHighPass (double frequency, double sampleRate, double q) noexcept
+{
+    // RBJ cookbook high-pass, normalised so that a0 == 1.
+    auto w0    = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    auto cosw0 = FastMath::cos (w0);
+    auto alpha = FastMath::sin (w0) / (2.0 * q);
+    auto a0    = 1.0 + alpha;
+
+    BiquadCoefficients c;
+    c.b0 = (1.0 + cosw0) * 0.5 / a0;
+    c.b1 = -(1.0 + cosw0) / a0;
+    c.b2 = c.b0;
+    c.a1 = -2.0 * cosw0 / a0;
+    c.a2 = (1.0 - alpha) / a0;
+    return c;
+}
+
+static BiquadCoefficients makeLowPass (double frequency, double sampleRate, double q) noexcept
+{
+    // RBJ cookbook low-pass, normalised so that a0 == 1.
+    auto w0    = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    auto cosw0 = FastMath::cos (w0);
+    auto alpha = FastMath::sin (w0) / (2.0 * q);
+    auto a0    = 1.0 + alpha;
+
+    BiquadCoefficients c;
+    c.b0 = (1.0 - cosw0) * 0.5 / a0;
+    c.b1 = (1.0 - cosw0) / a0;
+    c.b2 = c.b0;
+    c.a1 = -2.0 * cosw0 / a0;
+    c.a2 = (1.0 - alpha) / a0;
+    return c;
+}
+
+template <typename SectionDesigner>
+static CutFilterCoefficients makeButterworthCascade (double frequency, double sampleRate, Slope slope,
+                                                     SectionDesigner&& makeSection) noexcept
+{
+    jassert (sampleRate > 0.0);
+
+    // Keep the cutoff safely below Nyquist so the design never degenerates.
+    frequency = juce::jlimit (1.0, sampleRate * 0.49, frequency);
+
+    CutFilterCoefficients result;
+    result.numStages = (int) slope + 1;
+
+    for (int i = 0; i < result.numStages; ++i)
+        result.stages[(size_t) i] = makeSection (frequency, sampleRate, getButterworthStageQ (result.numStages, i));
+
+    return result;
+}
+
+CutFilterCoefficients makeLowCutCoefficients (double frequency, double sampleRate, Slope slope) noexcept
+{
+    return makeButterworthCascade (frequency, sampleRate, slope, makeHighPass);
+}
+
+CutFilterCoefficients makeHighCutCoefficients (double frequency, double sampleRate, Slope slope) noexcept
+{
+    return makeButterworthCascade (frequency, sampleRate, slope, makeLowPass);
+}
+
+BiquadCoefficients makePeakCoefficients (double frequency, double gainInDecibels, double quality, double sampleRate) noexcept
+{
+    jassert (sampleRate > 0.0 && quality > 0.0);
+
+    frequency = juce::jlimit (1.0, sampleRate * 0.49, frequency);
+
+    // RBJ cookbook peaking EQ, normalised so that a0 == 1. With no gain the
+    // numerator and denominator are identical.
+    auto A     = FastMath::pow10 (gainInDecibels / 40.0);
+    auto w0    = juce::MathConstants<double>::twoPi * frequency / sampleRate;
+    auto cosw0 = FastMath::cos (w0);
+    auto alpha = FastMath::sin (w0) / (2.0 * quality);
+    auto a0    = 1.0 + alpha / A;
+
+    BiquadCoefficients c;
+    c.b0 = (1.0 + alpha * A) / a0;
+    c.b1 = -2.0 * cosw0 / a0;
+    c.b2 = (1.0 - alpha * A) / a0;
+    c.a1 = c.b1;
+    c.a2 = (1.0 - alpha / A) / a0;
+    return c;
+}
+
+void makeLinearPhaseLowCut (double frequency, double sampleRate, Slope slope, bool bypassed,
+                            juce::AudioBuffer<float>& kernel)
+{
+    auto length = kernel.getNumSamples();
+    jassert (kernel.getNumChannels() == 1 && juce::isPowerOfTwo (length) && length >= 4);
+
+    // Sample the analogue Butterworth magnitude, |H| = 1 / sqrt (1 + (fc / f)^2n),
+    // on the FFT grid with a phase that delays it by half the kernel. With no
+    // warping to undo, it matches the cutoff exactly right up to Nyquist.
+    juce::dsp::FFT fft (juce::roundToInt (std::log2 ((double) length)));
+    std::vector<float> data ((size_t) (2 * length), 0.0f);
+
+    auto order = 2.0 * ((int) slope + 1);
+
+    for (int k = 0; k <= length / 2; ++k)
+    {
+        auto f = k * sampleRate / length;
+        auto magnitude = bypassed ? 1.0 : (k == 0 ? 0.0 : 1.0 / std::sqrt (1.0 + std::pow (frequency / f, 2.0 * order)));
+
+        // A delay of length / 2 samples turns every other bin upside down.
+        data[(size_t) (2 * k)] = (float) ((k & 1) != 0 ? -magnitude : magnitude);
+    }
+
+    fft.performRealOnlyInverseTransform (data.data());
+
+    // Window the symmetric impulse to keep the truncation ripple down.
+    auto* out = kernel.getWritePointer (0);
+
+    for (int i = 0; i < length; ++i)
+    {
+        auto phase = juce::MathConstants<double>::twoPi * i / length;
+        auto window = 0.42 - 0.5 * std::cos (phase) + 0.08 * std::cos (2.0 * phase);   // Blackman
+
+        out[i] = (float) (data[(size_t) i] * window);
+    }
+}
+
+//==============================================================================
+bool isLowCutBypassed (const FilterSettings& settings) noexcept
+{
+    // "LowCut Freq" starts at 20 Hz.
+    return settings.lowCutFreq <= 20.0f;
+}
+
+bool isHighCutBypassed (const FilterSettings& settings) noexcept
+{
+    // "HighCut Freq" ends at 20 kHz.
+    return settings.highCutFreq >= 20000.0f;
+}
+
+bool isTransparent (const BiquadCoefficients& c) noexcept
+{
+    constexpr auto tolerance = 1.0e-9;
+
+    return std::abs (c.b0 - 1.0)  < tolerance
+        && std::abs (c.b1 - c.a1) < tolerance
+        && std::abs (c.b2 - c.a2) < tolerance;
+}
+
+//==============================================================================
+static double getPoleRadius (const BiquadCoefficients& c) noexcept
+{
+    // The poles are the roots of z^2 + a1 z + a2.
+    auto discriminant = c.a1 * c.a1 - 4.0 * c.a2;
+
+    if (discriminant < 0.0)
+        return std::sqrt (c.a2);
+
+    auto root = std::sqrt (discriminant);
+    return juce::jmax (std::abs (-c.a1 + root), std::abs (-c.a1 - root)) * 0.5;
+}
+
+int getTailLengthSamples (const BiquadCoefficients* stages, int numStages) noexcept
+{
+    constexpr auto decayRatio = 1.0e-6;   // -120 dB
+    constexpr auto maxTailSamples = 1 << 24;
+
+    // Each section rings for as long as its slowest pole takes to decay, and in
+    // a cascade those add up.
+    double total = 0.0;
+
+    for (int i = 0; i < numStages; ++i)
+    {
+        auto radius = getPoleRadius (stages[i]);
+
+        if (radius >= 1.0)
+            return maxTailSamples;
+
+        if (radius > 0.0)
+            total += std::log (decayRatio) / std::log (radius);
+    }
+
+    return (int) juce::jmin ((double) maxTailSamples, std::ceil (total));
+}
+
+//==============================================================================
+ChainCoefficients makeChainCoefficients (const CutFilterCoefficients& lowCut,
+                                         const BiquadCoefficients& peak,
+                                         const CutFilterCoefficients& highCut) noexcept
+{
+    ChainCoefficients result;
+
+    auto append = [&result] (const BiquadCoefficients& section)
+    {
+        // Sections that wouldn't change the signal never reach the audio thread.
+        if (isTransparent (section))
+            return 0;
+
+        result.stages[(size_t) result.numStages++] = section;
+        return 1;
+    };
+
+    auto numLowCutStages = 0, numHighCutStages = 0;
+
+    for (int i = 0; i < lowCut.numStages; ++i)
+        numLowCutStages += append (lowCut.stages[(size_t) i]);
+
+    auto numPeakStages = append (peak);
+
+    for (int i = 0; i < highCut.numStages; ++i)
+        numHighCutStages += append (highCut.stages[(size_t) i]);
+
+    result.layout = numLowCutStages | (numPeakStages << 4) | (numHighCutStages << 8);
+
+    result.tailLengthSamples = getTailLengthSamples (result.stages.data(), result.numStages);
+    return result;
+}
+
+ChainCoefficients makeChainCoefficients (const FilterSettings& settings, double sampleRate) noexcept
+{
+    CutFilterCoefficients lowCut, highCut;
+
+    if (! isLowCutBypassed (settings))
+        lowCut = makeLowCutCoefficients (settings.lowCutFreq, sampleRate, settings.lowCutSlope);
+
+    if (! isHighCutBypassed (settings))
+        highCut = makeHighCutCoefficients (settings.highCutFreq, sampleRate, settings.highCutSlope);
+
+    auto peak = makePeakCoefficients (settings.peakFreq, settings.peakGainInDecibels, settings.peakQuality, sampleRate);
+
+    return makeChainCoefficients (lowCut, peak, highCut);
+}
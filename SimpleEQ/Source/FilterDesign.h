@@ -0,0 +1,174 @@
+/*
+  ==============================================================================
+
+    FilterDesign.h
+    Plain-data biquad coefficients and the designers that produce them.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/** Coefficients of one normalised (a0 == 1) second-order section.
+
+    Kept as plain doubles so that they can be copied between threads and
+    converted to whatever sample type the filter engine runs at.
+*/
+struct BiquadCoefficients
+{
+    double b0 = 1.0, b1 = 0.0, b2 = 0.0, a1 = 0.0, a2 = 0.0;
+};
+
+//==============================================================================
+/** The "LowCut Slope" and "HighCut Slope" choices, in the order they appear in
+    the parameters.
+*/
+enum Slope
+{
+    Slope_12,
+    Slope_24,
+    Slope_36,
+    Slope_48
+};
+
+/** A Butterworth cut filter of 12 * (slope + 1) dB/Oct, as a cascade of biquads. */
+struct CutFilterCoefficients
+{
+    static constexpr int maxStages = 4;
+
+    std::array<BiquadCoefficients, maxStages> stages;
+    int numStages = 0;
+};
+
+//==============================================================================
+/** The parameter values that the filter coefficients are designed from. */
+struct FilterSettings
+{
+    float lowCutFreq = 20.0f, highCutFreq = 20000.0f;
+    float peakFreq = 750.0f, peakGainInDecibels = 0.0f, peakQuality = 1.0f;
+    Slope lowCutSlope = Slope_12, highCutSlope = Slope_12;
+    bool linearPhaseLowCut = false;
+    int oversamplingFactor = 1;
+
+    bool operator== (const FilterSettings& other) const noexcept
+    {
+        return juce::approximatelyEqual (lowCutFreq, other.lowCutFreq)
+            && juce::approximatelyEqual (highCutFreq, other.highCutFreq)
+            && juce::approximatelyEqual (peakFreq, other.peakFreq)
+            && juce::approximatelyEqual (peakGainInDecibels, other.peakGainInDecibels)
+            && juce::approximatelyEqual (peakQuality, other.peakQuality)
+            && lowCutSlope == other.lowCutSlope
+            && highCutSlope == other.highCutSlope
+            && linearPhaseLowCut == other.linearPhaseLowCut
+            && oversamplingFactor == other.oversamplingFactor;
+    }
+
+    bool operator!= (const FilterSettings& other) const noexcept    { return ! operator== (other); }
+};
+
+/** Everything the audio thread needs to run the filter chain: the LowCut, Peak
+    and HighCut sections one after the other, as a single cascade.
+*/
+struct ChainCoefficients
+{
+    static constexpr int maxStages = 2 * CutFilterCoefficients::maxStages + 1;
+
+    std::array<BiquadCoefficients, maxStages> stages;
+    int numStages = 0;
+
+    /** Which sections of which bands are in use. Two sets with the same layout
+        can be swapped without disturbing the filter state.
+    */
+    int layout = 0;
+
+    /** How long the chain keeps ringing after its input stops, in samples at
+        the rate it was designed for.
+    */
+    int tailLengthSamples = 0;
+
+    /** The multiple of the host's sample rate that the stages were designed
+        for, and so have to be run at.
+    */
+    int oversamplingFactor = 1;
+
+    /** True if the LowCut is left out of the stages because it's being applied
+        by the linear-phase convolution instead.
+    */
+    bool linearPhaseLowCut = false;
+
+    /** True if the change to these coefficients should be crossfaded even if
+        the layout is the same, because the jump is too big to make in one
+        step, as when a preset is loaded.
+    */
+    bool crossfade = false;
+
+    /** The number of MIDI controller changes the parameters included when
+        these were designed; see CoefficientPublisher::applyControllerChange().
+    */
+    juce::uint32 controllerSequence = 0;
+};
+
+/** Each band's sections on their own, before they're strung together, so that
+    when one band changes the other two don't have to be designed again.
+*/
+struct BandCoefficients
+{
+    CutFilterCoefficients lowCut, highCut;
+    BiquadCoefficients peak;
+};
+
+//==============================================================================
+/** Returns the quality factor of each second-order section in an even-order
+    Butterworth filter made of numStages biquads.
+*/
+double getButterworthStageQ (int numStages, int stageIndex) noexcept;
+
+/** Designs a Butterworth high-pass cascade at the given cutoff frequency. */
+CutFilterCoefficients makeLowCutCoefficients (double frequency, double sampleRate, Slope slope) noexcept;
+
+/** Designs a Butterworth low-pass cascade at the given cutoff frequency. */
+CutFilterCoefficients makeHighCutCoefficients (double frequency, double sampleRate, Slope slope) noexcept;
+
+/** Designs a linear-phase FIR with the magnitude response of a Butterworth
+    high-pass, filling the whole of a single-channel buffer whose length is a
+    power of two. The impulse is centred on sample getNumSamples() / 2, which is
+    the filter's latency. If bypassed is true the result is a pure delay.
+*/
+void makeLinearPhaseLowCut (double frequency, double sampleRate, Slope slope, bool bypassed,
+                            juce::AudioBuffer<float>& kernel);
+
+/** Designs a peaking bell filter. At 0 dB it is transparent. */
+BiquadCoefficients makePeakCoefficients (double frequency, double gainInDecibels, double quality, double sampleRate) noexcept;
+
+/** True when "LowCut Freq" is at the bottom of its range, which switches the
+    low cut off altogether rather than leaving a cut at 20 Hz running.
+*/
+bool isLowCutBypassed (const FilterSettings& settings) noexcept;
+
+/** True when "HighCut Freq" is at the top of its range, which likewise switches
+    the high cut off.
+*/
+bool isHighCutBypassed (const FilterSettings& settings) noexcept;
+
+/** True if a section's numerator matches its denominator, so that it passes
+    every signal through unchanged.
+*/
+bool isTransparent (const BiquadCoefficients& coefficients) noexcept;
+
+/** Returns the number of samples it takes a cascade's impulse response to
+    decay below -120 dB, estimated from the radius of each section's poles.
+*/
+int getTailLengthSamples (const BiquadCoefficients* stages, int numStages) noexcept;
+
+/** Strings the three bands together into one cascade, leaving out any section
+    that wouldn't change the signal, and works out the chain's tail.
+*/
+ChainCoefficients makeChainCoefficients (const CutFilterCoefficients& lowCut,
+                                         const BiquadCoefficients& peak,
+                                         const CutFilterCoefficients& highCut) noexcept;
+
+/** Designs every filter in the chain for the given settings. */
+ChainCoefficients makeChainCoefficients (const FilterSettings& settings, double sampleRate) noexcept;
@@ -0,0 +1,175 @@
+/*
+  ==============================================================================
+
+    LinearPhaseLowCut.cpp
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseLowCut.h"
+
+//==============================================================================
+LinearPhaseLowCut::LinearPhaseLowCut (juce::AudioProcessorValueTreeState& state)
+    : parameters (state)
+{
+    designThread->addTimeSliceClient (this);
+}
+
+LinearPhaseLowCut::~LinearPhaseLowCut()
+{
+    // Blocks until the design thread has finished with us.
+    designThread->removeTimeSliceClient (this);
+}
+
+//==============================================================================
+void LinearPhaseLowCut::prepare (double sampleRate, int maximumBlockSize, int numChannels, int partitionSize)
+{
+    jassert (sampleRate > 0.0 && maximumBlockSize > 0 && partitionSize > 0);
+
+    const juce::ScopedLock sl (writerLock);
+
+    currentSampleRate = sampleRate;
+    maxBlockSize = maximumBlockSize;
+    kernelLength = juce::nextPowerOfTwo (juce::roundToInt (sampleRate * kernelSeconds));
+
+    convolutions.clear();
+
+    for (int ch = 0; ch < numChannels; ch += 2)
+        convolutions.add (new juce::dsp::Convolution (juce::dsp::Convolution::Latency { partitionSize }, *messageQueue));
+
+    // Loading before prepare() means the kernel is in place for the first block.
+    auto& snapshot = parameters.update();
+    loadKernel (snapshot[ParameterSnapshot::lowCutFreq], static_cast<Slope> ((int) snapshot[ParameterSnapshot::lowCutSlope]));
+
+    for (int i = 0; i < convolutions.size(); ++i)
+    {
+        auto channels = juce::jmin (2, numChannels - 2 * i);
+        convolutions.getUnchecked (i)->prepare ({ sampleRate, (juce::uint32) maximumBlockSize, (juce::uint32) channels });
+    }
+
+    floatScratch.setSize (juce::jmin (2, numChannels), maximumBlockSize);
+}
+
+void LinearPhaseLowCut::reset() noexcept
+{
+    for (auto* convolution : convolutions)
+        convolution->reset();
+}
+
+int LinearPhaseLowCut::getLatencySamples() const noexcept
+{
+    auto engineLatency = convolutions.isEmpty() ? 0 : convolutions.getFirst()->getLatency();
+    return kernelLength / 2 + engineLatency;
+}
+
+int LinearPhaseLowCut::getTailLengthSamples() const noexcept
+{
+    return getLatencySamples() + kernelLength / 2;
+}
+
+void LinearPhaseLowCut::loadKernel (float frequency, Slope slope)
+{
+    FilterSettings settings;
+    settings.lowCutFreq = frequency;
+
+    for (auto* convolution : convolutions)
+    {
+        juce::AudioBuffer<float> kernel (1, kernelLength);
+        makeLinearPhaseLowCut (frequency, currentSampleRate, slope, isLowCutBypassed (settings), kernel);
+
+        // The buffer is moved into the convolution, which does the
+        // partitioning on its own background thread.
+
+        convolution->loadImpulseResponse (std::move (kernel), currentSampleRate,
+                                          juce::dsp::Convolution::Stereo::no,
+                                          juce::dsp::Convolution::Trim::no,
+                                          juce::dsp::Convolution::Normalise::no);
+    }
+
+    lastFrequency = frequency;
+    lastSlope = slope;
+}
+
+//==============================================================================
+int LinearPhaseLowCut::useTimeSlice()
+{
+    const juce::ScopedLock sl (writerLock);
+
+    if (currentSampleRate > 0.0)
+    {
+        auto& snapshot = parameters.update();
+
+        // In minimum-phase mode the kernel isn't heard, so it's left alone
+        // until the mode changes back. Switching back only needs a new kernel
+        // if the LowCut moved in the meantime.
+        if (snapshot[ParameterSnapshot::lowCutMode] >= 0.5f && snapshot.hasChanged (ParameterSnapshot::lowCutBand))
+        {
+            auto frequency = snapshot[ParameterSnapshot::lowCutFreq];
+            auto slope = static_cast<Slope> ((int) snapshot[ParameterSnapshot::lowCutSlope]);
+
+            if (! juce::approximatelyEqual (frequency, lastFrequency) || slope != lastSlope)
+                loadKernel (frequency, slope);
+        }
+    }
+
+    return pollIntervalMs;
+}
+
+//==============================================================================
+template <typename SampleType>
+void LinearPhaseLowCut::process (const juce::dsp::AudioBlock<SampleType>& block, int numChannels) noexcept
+{
+    jassert ((numChannels + 1) / 2 <= convolutions.size());
+
+    // The convolution was prepared for blocks of up to maxBlockSize.
+    for (size_t start = 0; start < block.getNumSamples(); start += (size_t) maxBlockSize)
+        processChunk (block.getSubBlock (start, juce::jmin ((size_t) maxBlockSize, block.getNumSamples() - start)), numChannels);
+}
+
+template <typename SampleType>
+void LinearPhaseLowCut::processChunk (const juce::dsp::AudioBlock<SampleType>& block, int numChannels) noexcept
+{
+    auto numSamples = (int) block.getNumSamples();
+
+    for (int i = 0; i < convolutions.size(); ++i)
+    {
+        auto firstChannel = 2 * i;
+        auto channels = juce::jmin (2, numChannels - firstChannel);
+
+        if (channels <= 0)
+            break;
+
+        if constexpr (std::is_same_v<SampleType, float>)
+        {
+            auto pair = block.getSubsetChannelBlock ((size_t) firstChannel, (size_t) channels);
+            convolutions.getUnchecked (i)->process (juce::dsp::ProcessContextReplacing<float> (pair));
+        }
+        else
+        {
+            for (int ch = 0; ch < channels; ++ch)
+            {
+                auto* source = block.getChannelPointer ((size_t) (firstChannel + ch));
+                auto* dest = floatScratch.getWritePointer (ch);
+
+                for (int n = 0; n < numSamples; ++n)
+                    dest[n] = static_cast<float> (source[n]);
+            }
+
+            auto scratch = juce::dsp::AudioBlock<float> (floatScratch).getSubsetChannelBlock (0, (size_t) channels)
+                                                                      .getSubBlock (0, (size_t) numSamples);
+            convolutions.getUnchecked (i)->process (juce::dsp::ProcessContextReplacing<float> (scratch));
+
+            for (int ch = 0; ch < channels; ++ch)
+            {
+                auto* source = floatScratch.getReadPointer (ch);
+                auto* dest = block.getChannelPointer ((size_t) (firstChannel + ch));
+
+                for (int n = 0; n < numSamples; ++n)
+                    dest[n] = static_cast<SampleType> (source[n]);
+            }
+        }
+    }
+}
+
+template void LinearPhaseLowCut::process<float>  (const juce::dsp::AudioBlock<float>&,  int) noexcept;
+template void LinearPhaseLowCut::process<double> (const juce::dsp::AudioBlock<double>&, int) noexcept;
@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    LinearPhaseLowCut.h
+    The LowCut as a linear-phase FIR, applied by partitioned convolution.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FilterDesign.h"
+#include "CoefficientPublisher.h"
+#include "ParameterSnapshot.h"
+
+//==============================================================================
+/**
+    Applies the LowCut as a linear-phase FIR instead of a Butterworth cascade,
+    so that nothing above the cutoff is shifted in time.
+
+    The kernel has the Butterworth magnitude for the chosen frequency and slope
+    and is redesigned on the shared design thread whenever they change. It's run
+    through juce::dsp::Convolution with a uniformly partitioned engine: the
+    partition size sets the engine's latency, and larger partitions cost less
+    CPU. New kernels are handed to the convolution's background loader, which
+    prepares them off the audio thread and crossfades to them, so a change
+    never clicks and never allocates on the audio thread.
+
+    The total latency is half the kernel length plus the partition size.
+*/
+class LinearPhaseLowCut  : private juce::TimeSliceClient
+{
+public:
+    //==============================================================================
+    /** The partition sizes offered by the "LowCut Partition" parameter. */
+    static constexpr std::array<int, 6> partitionSizes { 64, 128, 256, 512, 1024, 2048 };
+
+    explicit LinearPhaseLowCut (juce::AudioProcessorValueTreeState& state);
+    ~LinearPhaseLowCut() override;
+
+    /** Allocates everything and loads a kernel for the current settings.
+        Must not be called concurrently with process().
+    */
+    void prepare (double sampleRate, int maximumBlockSize, int numChannels, int partitionSize);
+
+    /** Clears the convolution's history. */
+    void reset() noexcept;
+
+    /** The delay the filter adds, in samples. */
+    int getLatencySamples() const noexcept;
+
+    /** How long the output keeps going after the input stops. */
+    int getTailLengthSamples() const noexcept;
+
+    /** Filters the first numChannels channels of the block in place. Doubles
+        are converted to float for the convolution and back.
+    */
+    template <typename SampleType>
+    void process (const juce::dsp::AudioBlock<SampleType>& block, int numChannels) noexcept;
+
+private:
+    //==============================================================================
+    int useTimeSlice() override;
+    void loadKernel (float frequency, Slope slope);
+
+    template <typename SampleType>
+    void processChunk (const juce::dsp::AudioBlock<SampleType>& block, int numChannels) noexcept;
+
+    //==============================================================================
+    // The kernel is about this long, rounded up to a power of two.
+    static constexpr double kernelSeconds = 0.3;
+
+    // How often the design thread looks for parameter changes. Each new kernel
+    // starts a crossfade, so this also limits how often those can happen.
+    static constexpr int pollIntervalMs = 20;
+
+    // Serialises prepare() against the design thread. The audio thread never
+    // takes it. Snapshots are only taken with it held.
+    juce::CriticalSection writerLock;
+    ParameterSnapshotReader parameters;
+    double currentSampleRate = 0.0;
+    int kernelLength = 0, maxBlockSize = 0;
+    float lastFrequency = 0.0f;
+    Slope lastSlope = Slope_12;
+
+    // Declared before the convolutions, which use it until they're destroyed.
+    juce::SharedResourcePointer<juce::dsp::ConvolutionMessageQueue> messageQueue;
+
+    // Each convolution handles a pair of channels.
+    juce::OwnedArray<juce::dsp::Convolution> convolutions;
+    juce::AudioBuffer<float> floatScratch;
+
+    juce::SharedResourcePointer<FilterDesignThread> designThread;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (LinearPhaseLowCut)
+};
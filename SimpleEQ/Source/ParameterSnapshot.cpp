@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    ParameterSnapshot.cpp
+
+  ==============================================================================
+*/
+
+#include "ParameterSnapshot.h"
+
+//==============================================================================
+FilterSettings ParameterSnapshot::getFilterSettings() const noexcept
+{
+    FilterSettings settings;
+    settings.lowCutFreq         = values[lowCutFreq];
+    settings.lowCutSlope        = static_cast<Slope> ((int) values[lowCutSlope]);
+    settings.highCutFreq        = values[highCutFreq];
+    settings.highCutSlope       = static_cast<Slope> ((int) values[highCutSlope]);
+    settings.peakFreq           = values[peakFreq];
+    settings.peakGainInDecibels = values[peakGain];
+    settings.peakQuality        = values[peakQuality];
+    settings.linearPhaseLowCut  = values[lowCutMode] >= 0.5f;
+    settings.oversamplingFactor = 1 << (int) values[oversampling];
+    return settings;
+}
+
+//==============================================================================
+ParameterSnapshotReader::ParameterSnapshotReader (juce::AudioProcessorValueTreeState& state)
+{
+    for (size_t i = 0; i < sources.size(); ++i)
+    {
+        sources[i] = state.getRawParameterValue (ParameterSnapshot::parameterIDs[i]);
+        jassert (sources[i] != nullptr);
+    }
+}
+
+const ParameterSnapshot& ParameterSnapshotReader::update() noexcept
+{
+    auto changed = forcedChanges;
+
+    for (int i = 0; i < ParameterSnapshot::numParameters; ++i)
+    {
+        auto value = sources[(size_t) i]->load (std::memory_order_relaxed);
+
+        if (value != snapshot.values[i])
+            changed |= ParameterSnapshot::bit (i);
+
+        snapshot.values[i] = value;
+    }
+
+    snapshot.changed = changed;
+    forcedChanges = 0;
+    return snapshot;
+}
+
+ParameterSnapshot ParameterSnapshotReader::read() const noexcept
+{
+    ParameterSnapshot result;
+
+    for (int i = 0; i < ParameterSnapshot::numParameters; ++i)
+        result.values[i] = sources[(size_t) i]->load (std::memory_order_relaxed);
+
+    return result;
+}
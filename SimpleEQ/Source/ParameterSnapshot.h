@@ -0,0 +1,114 @@
+/*
+  ==============================================================================
+
+    ParameterSnapshot.h
+    Every parameter's value at one moment, and which of them have changed.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FilterDesign.h"
+
+//==============================================================================
+/**
+    The values of all of SimpleEQ's parameters, copied out of the
+    AudioProcessorValueTreeState together into a single cache line, with a bit
+    set in `changed` for each one that is different from the previous snapshot.
+
+    Whatever works from the parameters takes a snapshot once per update and
+    only redoes the work for the parts whose bits are set, so moving the Peak
+    gain redesigns the Peak and nothing else, and an update in which nothing
+    moved costs one cache line of loads.
+
+    The first CoefficientPublisher::numControllableParameters indices are the
+    parameters that MIDI controllers can move, so a controller slot is also a
+    ParameterSnapshot index.
+*/
+struct alignas (64) ParameterSnapshot
+{
+    enum Index
+    {
+        lowCutFreq,
+        lowCutSlope,
+        peakFreq,
+        peakGain,
+        peakQuality,
+        highCutFreq,
+        highCutSlope,
+        lowCutMode,
+        lowCutPartition,
+        oversampling,
+        oversamplingFilter,
+        filterEngine,
+        numParameters
+    };
+
+    /** The parameter IDs, by index. */
+    static constexpr const char* parameterIDs[numParameters]
+        = { "LowCut Freq", "LowCut Slope", "Peak Freq", "Peak Gain", "Peak Quality", "HighCut Freq", "HighCut Slope",
+            "LowCut Mode", "LowCut Partition", "Oversampling", "Oversampling Filter",
+            "Filter Engine" };
+
+    static constexpr juce::uint32 bit (int index) noexcept      { return 1u << index; }
+
+    // The parameters each band's coefficients are designed from. The
+    // oversampling factor sets the rate they're designed for, so it's in all three.
+    static constexpr juce::uint32 allParameters = (1u << numParameters) - 1;
+    static constexpr juce::uint32 lowCutBand    = (1u << lowCutFreq) | (1u << lowCutSlope) | (1u << lowCutMode) | (1u << oversampling);
+    static constexpr juce::uint32 peakBand      = (1u << peakFreq) | (1u << peakGain) | (1u << peakQuality) | (1u << oversampling);
+    static constexpr juce::uint32 highCutBand   = (1u << highCutFreq) | (1u << highCutSlope) | (1u << oversampling);
+
+    float operator[] (Index index) const noexcept               { return values[index]; }
+    bool hasChanged (juce::uint32 mask) const noexcept          { return (changed & mask) != 0; }
+
+    /** The values that the filters are designed from. */
+    FilterSettings getFilterSettings() const noexcept;
+
+    float values[numParameters] {};
+    juce::uint32 changed = 0;
+};
+
+static_assert (sizeof (ParameterSnapshot) == 64, "A snapshot should fill exactly one cache line");
+
+//==============================================================================
+/**
+    Takes ParameterSnapshots of an AudioProcessorValueTreeState. The raw values
+    are looked up by ID once, here, so taking a snapshot is just a load from
+    each of them.
+
+    Each reader remembers the previous snapshot it took, so every thread that
+    needs to know what has changed keeps a reader of its own.
+*/
+class ParameterSnapshotReader
+{
+public:
+    explicit ParameterSnapshotReader (juce::AudioProcessorValueTreeState& state);
+
+    /** Takes a new snapshot, marking what has changed since the last call.
+        The first call, and the first after invalidate(), marks everything.
+        Only call this from the thread that owns the reader.
+    */
+    const ParameterSnapshot& update() noexcept;
+
+    /** The snapshot taken by the last call to update(). */
+    const ParameterSnapshot& get() const noexcept       { return snapshot; }
+
+    /** Makes the next update() mark every parameter as changed, for when
+        whatever the values were used for has to be redone anyway.
+    */
+    void invalidate() noexcept                          { forcedChanges = ParameterSnapshot::allParameters; }
+
+    /** The current values, without touching the snapshot or what counts as
+        changed. Safe to call from any thread.
+    */
+    ParameterSnapshot read() const noexcept;
+
+private:
+    std::array<std::atomic<float>*, ParameterSnapshot::numParameters> sources {};
+    ParameterSnapshot snapshot;
+    juce::uint32 forcedChanges = ParameterSnapshot::allParameters;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ParameterSnapshotReader)
+};
@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    ParameterState.cpp
+
+  ==============================================================================
+*/
+
+#include "ParameterState.h"
+
+//==============================================================================
+static constexpr juce::uint32 stateMagic = 0x50514553;     // "SEQP" in file order
+static constexpr juce::uint16 stateVersion = 1;
+static constexpr int headerSize = 16;
+static constexpr int entrySize = 8;
+
+juce::uint32 fnv1a (const void* data, size_t numBytes) noexcept
+{
+    auto* bytes = static_cast<const juce::uint8*> (data);
+    juce::uint32 hash = 2166136261u;
+
+    for (size_t i = 0; i < numBytes; ++i)
+        hash = (hash ^ bytes[i]) * 16777619u;
+
+    return hash;
+}
+
+static juce::uint32 hashParameterID (const juce::String& paramID) noexcept
+{
+    auto* utf8 = paramID.toRawUTF8();
+    return fnv1a (utf8, std::strlen (utf8));
+}
+
+static void writeUInt16 (char* dest, juce::uint16 value) noexcept
+{
+    value = juce::ByteOrder::swapIfBigEndian (value);
+    std::memcpy (dest, &value, sizeof (value));
+}
+
+static void writeUInt32 (char* dest, juce::uint32 value) noexcept
+{
+    value = juce::ByteOrder::swapIfBigEndian (value);
+    std::memcpy (dest, &value, sizeof (value));
+}
+
+static juce::Array<juce::RangedAudioParameter*> getRangedParameters (const juce::AudioProcessor& processor)
+{
+    juce::Array<juce::RangedAudioParameter*> result;
+
+    for (auto* p : processor.getParameters())
+        if (auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (p))
+            result.add (ranged);
+
+    return result;
+}
+
+//==============================================================================
+void writeParameterState (const juce::AudioProcessor& processor, juce::MemoryBlock& destData)
+{
+    std::vector<std::pair<juce::String, float>> values;
+
+    for (auto* p : getRangedParameters (processor))
+        values.emplace_back (p->paramID, p->convertFrom0to1 (p->getValue()));
+
+    writeParameterState (values, destData);
+}
+
+void writeParameterState (const std::vector<std::pair<juce::String, float>>& values, juce::MemoryBlock& destData)
+{
+    auto numEntries = (int) values.size();
+
+    destData.setSize ((size_t) (headerSize + numEntries * entrySize), true);
+    auto* header = static_cast<char*> (destData.getData());
+    auto* entry = header + headerSize;
+
+    for (auto& [paramID, value] : values)
+    {
+        auto hash = hashParameterID (paramID);
+
+        juce::uint32 valueBits;
+        std::memcpy (&valueBits, &value, sizeof (valueBits));
+
+        writeUInt32 (entry, hash);
+        writeUInt32 (entry + 4, valueBits);
+        entry += entrySize;
+
+        // Two IDs with the same hash couldn't be told apart when loading.
+        jassert (std::count_if (values.begin(), values.end(),
+                                [hash] (auto& other) { return hashParameterID (other.first) == hash; }) == 1);
+    }
+
+    writeUInt32 (header,      stateMagic);
+    writeUInt16 (header + 4,  stateVersion);
+    writeUInt16 (header + 6,  (juce::uint16) entrySize);
+    writeUInt32 (header + 8,  (juce::uint32) numEntries);
+    writeUInt32 (header + 12, fnv1a (header + headerSize, (size_t) (numEntries * entrySize)));
+}
+
+bool readParameterState (juce::AudioProcessor& processor, const void* data, int sizeInBytes)
+{
+    if (data == nullptr || sizeInBytes < headerSize)
+        return false;
+
+    auto* header = static_cast<const char*> (data);
+
+    auto version         = juce::ByteOrder::littleEndianShort (header + 4);
+    auto storedEntrySize = (int) juce::ByteOrder::littleEndianShort (header + 6);
+    auto numEntries      = juce::ByteOrder::littleEndianInt (header + 8);
+
+    if (juce::ByteOrder::littleEndianInt (header) != stateMagic
+         || version == 0
+         || storedEntrySize < entrySize
+         || numEntries > (juce::uint32) ((sizeInBytes - headerSize) / storedEntrySize))
+        return false;
+
+    auto entriesSize = (size_t) numEntries * (size_t) storedEntrySize;
+
+    if (fnv1a (header + headerSize, entriesSize) != juce::ByteOrder::littleEndianInt (header + 12))
+        return false;
+
+    auto parameters = getRangedParameters (processor);
+
+    juce::Array<juce::uint32> hashes;
+
+    for (auto* p : parameters)
+        hashes.add (hashParameterID (p->paramID));
+
+    // Work out every new value first, then apply them all together.
+    juce::Array<std::pair<juce::RangedAudioParameter*, float>> newValues;
+    auto* entry = header + headerSize;
+
+    for (juce::uint32 i = 0; i < numEntries; ++i, entry += storedEntrySize)
+    {
+        auto index = hashes.indexOf (juce::ByteOrder::littleEndianInt (entry));
+
+        if (index < 0)
+            continue;
+
+        auto valueBits = juce::ByteOrder::littleEndianInt (entry + 4);
+        float value;
+        std::memcpy (&value, &valueBits, sizeof (value));
+
+        if (std::isfinite (value))
+            newValues.add ({ parameters.getUnchecked (index), value });
+    }
+
+    for (auto& [parameter, value] : newValues)
+    {
+        auto normalised = parameter->convertTo0to1 (value);
+
+        if (! juce::approximatelyEqual (parameter->getValue(), normalised))
+            parameter->setValueNotifyingHost (normalised);
+    }
+
+    return true;
+}
@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    ParameterState.h
+    A compact binary format for saving and restoring parameter values.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    SimpleEQ saves its parameters as a small fixed-layout block rather than an
+    XML document, so that reloading a session with hundreds of instances
+    doesn't spend its time parsing text.
+
+    Layout, all little-endian:
+
+        offset  size
+        0       4       magic, "SEQP"
+        4       2       format version
+        6       2       size of one entry in bytes
+        8       4       number of entries
+        12      4       FNV-1a checksum of the entries
+        16      ...     the entries
+
+    Each entry is the FNV-1a hash of a parameter ID followed by the parameter's
+    plain (not normalised) value as a 32-bit float. Keeping the value in its
+    own units means a parameter's range can change without breaking old
+    sessions.
+
+    Entries for IDs that this build doesn't know about are skipped, and
+    parameters that aren't in the data keep their current values, so states
+    written before and after a parameter is added both load. A later version
+    may append fields to each entry; readers step over what they don't use.
+*/
+
+/** Writes the values of all the processor's ranged parameters. */
+void writeParameterState (const juce::AudioProcessor& processor, juce::MemoryBlock& destData);
+
+/** Writes a state holding the given plain values, keyed by parameter ID. This
+    is how presets are built without a processor to read them from.
+*/
+void writeParameterState (const std::vector<std::pair<juce::String, float>>& values, juce::MemoryBlock& destData);
+
+/** Restores parameter values written by writeParameterState().
+
+    The whole block is validated before anything is applied, and all the
+    values are then set in one pass. Returns false, leaving the parameters
+    untouched, if the data isn't a valid state.
+*/
+bool readParameterState (juce::AudioProcessor& processor, const void* data, int sizeInBytes);
+
+/** The 32-bit FNV-1a hash used for the checksum and the parameter IDs. */
+juce::uint32 fnv1a (const void* data, size_t numBytes) noexcept;
@@ -13,28 +13,147 @@
 SimpleEQAudioProcessorEditor::SimpleEQAudioProcessorEditor (SimpleEQAudioProcessor& p)
     : AudioProcessorEditor (&p), audioProcessor (p)
 {
+    addAndMakeVisible (analyzer);
+    addAndMakeVisible (responseCurve);
+
+   #if PROCESS_PROFILER_ENABLED
+    addAndMakeVisible (profilerView);
+   #endif
+
+    presetBox.setTextWhenNothingSelected ("Presets");
+    presetBox.onChange = [this]
+    {
+        auto index = presetBox.getSelectedItemIndex();
+
+        if (index >= 0 && index != audioProcessor.getCurrentProgram())
+            audioProcessor.setCurrentProgram (index);
+    };
+
+    savePresetButton.onClick = [this] { askForPresetName(); };
+
+    addAndMakeVisible (presetBox);
+    addAndMakeVisible (savePresetButton);
+    updatePresetList();
+
+    for (auto* parameter : audioProcessor.getParameters())
+    {
+        auto* ranged = dynamic_cast<juce::RangedAudioParameter*> (parameter);
+
+        if (ranged == nullptr)
+            continue;
+
+        auto* label = labels.add (new juce::Label ({}, ranged->getName (32)));
+        label->setJustificationType (juce::Justification::centred);
+        addAndMakeVisible (label);
+
+        if (auto* choice = dynamic_cast<juce::AudioParameterChoice*> (ranged))
+        {
+            auto* comboBox = new juce::ComboBox();
+            comboBox->addItemList (choice->choices, 1);
+            controls.add (comboBox);
+            comboBoxAttachments.add (new juce::AudioProcessorValueTreeState::ComboBoxAttachment (audioProcessor.apvts, ranged->paramID, *comboBox));
+        }
+        else
+        {
+            auto* slider = new juce::Slider (juce::Slider::RotaryHorizontalVerticalDrag, juce::Slider::TextBoxBelow);
+            controls.add (slider);
+            sliderAttachments.add (new juce::AudioProcessorValueTreeState::SliderAttachment (audioProcessor.apvts, ranged->paramID, *slider));
+        }
+
+        addAndMakeVisible (controls.getLast());
+    }
+
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
-    setSize (400, 300);
+   #if PROCESS_PROFILER_ENABLED
+    setSize (800, 732);
+   #else
+    setSize (800, 592);
+   #endif
 }
 
 SimpleEQAudioProcessorEditor::~SimpleEQAudioProcessorEditor()
 {
 }
 
+//==============================================================================
+void SimpleEQAudioProcessorEditor::updatePresetList()
+{
+    presetBox.clear (juce::dontSendNotification);
+
+    for (int i = 0; i < audioProcessor.getNumPrograms(); ++i)
+        presetBox.addItem (audioProcessor.getProgramName (i), i + 1);
+
+    presetBox.setSelectedItemIndex (audioProcessor.getCurrentProgram(), juce::dontSendNotification);
+}
+
+void SimpleEQAudioProcessorEditor::askForPresetName()
+{
+    auto* window = new juce::AlertWindow ("Save Preset", "Save the current settings as:", juce::MessageBoxIconType::NoIcon, this);
+    window->addTextEditor ("name", audioProcessor.getProgramName (audioProcessor.getCurrentProgram()));
+    window->addButton ("Save", 1, juce::KeyPress (juce::KeyPress::returnKey));
+    window->addButton ("Cancel", 0, juce::KeyPress (juce::KeyPress::escapeKey));
+
+    juce::Component::SafePointer<SimpleEQAudioProcessorEditor> editor (this);
+
+    window->enterModalState (true, juce::ModalCallbackFunction::create ([editor, window] (int result)
+    {
+        auto name = window->getTextEditorContents ("name").trim();
+
+        if (editor == nullptr || result == 0 || name.isEmpty())
+            return;
+
+        if (! editor->audioProcessor.saveUserPreset (name))
+            juce::AlertWindow::showMessageBoxAsync (juce::MessageBoxIconType::WarningIcon, "Save Preset",
+                                                    "\"" + name + "\" couldn't be saved. Factory presets can't be overwritten.");
+
+        editor->updatePresetList();
+    }), true);
+}
+
 //==============================================================================
 void SimpleEQAudioProcessorEditor::paint (juce::Graphics& g)
 {
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
 }
 
 void SimpleEQAudioProcessorEditor::resized()
 {
-    // This is generally where you'll want to lay out the positions of any
-    // subcomponents in your editor..
+    auto bounds = getLocalBounds().reduced (8);
+
+   #if PROCESS_PROFILER_ENABLED
+    profilerView.setBounds (bounds.removeFromBottom (132));
+    bounds.removeFromBottom (8);
+   #endif
+
+    auto presetRow = bounds.removeFromTop (24);
+    savePresetButton.setBounds (presetRow.removeFromRight (120));
+    presetRow.removeFromRight (8);
+    presetBox.setBounds (presetRow);
+    bounds.removeFromTop (8);
+
+    analyzer.setBounds (bounds.removeFromTop (bounds.getHeight() / 2));
+    responseCurve.setBounds (analyzer.getBounds());
+    bounds.removeFromTop (8);
+
+    // The controls in rows of up to columns, each a label over its control.
+    constexpr int columns = 6;
+    auto rows = (controls.size() + columns - 1) / columns;
+    auto cellWidth = bounds.getWidth() / columns;
+    auto cellHeight = bounds.getHeight() / juce::jmax (1, rows);
+
+    for (int i = 0; i < controls.size(); ++i)
+    {
+        auto cell = juce::Rectangle<int> (bounds.getX() + (i % columns) * cellWidth,
+                                          bounds.getY() + (i / columns) * cellHeight,
+                                          cellWidth, cellHeight).reduced (4);
+
+        labels[i]->setBounds (cell.removeFromTop (18));
+
+        if (dynamic_cast<juce::ComboBox*> (controls[i]) != nullptr)
+            controls[i]->setBounds (cell.withSizeKeepingCentre (cell.getWidth(), 24));
+        else
+            controls[i]->setBounds (cell);
+    }
 }
@@ -10,9 +10,14 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "SpectrumAnalyzer.h"
+#include "ResponseCurveComponent.h"
 
 //==============================================================================
 /**
+    The preset menu, then the spectrum analyzer with the filters' response
+    drawn over it, above a control for each parameter: a rotary slider for the
+    continuous ones and a combo box for the choices.
 */
 class SimpleEQAudioProcessorEditor  : public juce::AudioProcessorEditor
 {
@@ -25,9 +30,27 @@ public:
     void resized() override;
 
 private:
+    void updatePresetList();
+    void askForPresetName();
+
     // This reference is provided as a quick way for your editor to
     // access the processor object that created it.
     SimpleEQAudioProcessor& audioProcessor;
 
+    SpectrumAnalyzerComponent analyzer { audioProcessor };
+    ResponseCurveComponent responseCurve { audioProcessor, audioProcessor.apvts };
+
+   #if PROCESS_PROFILER_ENABLED
+    ProcessProfilerComponent profilerView { audioProcessor.getProfiler() };
+   #endif
+
+    juce::ComboBox presetBox;
+    juce::TextButton savePresetButton { "Save Preset..." };
+
+    juce::OwnedArray<juce::Label> labels;
+    juce::OwnedArray<juce::Component> controls;
+    juce::OwnedArray<juce::AudioProcessorValueTreeState::SliderAttachment> sliderAttachments;
+    juce::OwnedArray<juce::AudioProcessorValueTreeState::ComboBoxAttachment> comboBoxAttachments;
+
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessorEditor)
 };
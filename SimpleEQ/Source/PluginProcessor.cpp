@@ -8,6 +8,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "ParameterState.h"
 
 //==============================================================================
 SimpleEQAudioProcessor::SimpleEQAudioProcessor()
@@ -22,10 +23,19 @@ SimpleEQAudioProcessor::SimpleEQAudioProcessor()
                        )
 #endif
 {
+    for (auto* paramID : { "LowCut Mode", "Oversampling", "Oversampling Filter" })
+        apvts.addParameterListener (paramID, this);
+
+    for (int slot = 0; slot < CoefficientPublisher::numControllableParameters; ++slot)
+        controllers.mapController (firstController + slot, slot);
 }
 
 SimpleEQAudioProcessor::~SimpleEQAudioProcessor()
 {
+    for (auto* paramID : { "LowCut Mode", "Oversampling", "Oversampling Filter" })
+        apvts.removeParameterListener (paramID, this);
+
+    cancelPendingUpdate();
 }
 
 //==============================================================================
@@ -63,38 +73,145 @@ bool SimpleEQAudioProcessor::isMidiEffect() const
 
 double SimpleEQAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    auto tail = coefficientPublisher.getTailLengthSeconds();
+
+    if (isLinearPhaseLowCut() && getSampleRate() > 0.0)
+        tail += linearPhaseLowCut.getTailLengthSamples() / getSampleRate();
+
+    return tail;
 }
 
 int SimpleEQAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
-                // so this should be at least 1, even if you're not really implementing programs.
+    // NB: some hosts don't cope very well if you tell them there are 0 programs,
+    // so this is at least 1 even if the bank couldn't be opened.
+    return juce::jmax (1, presetBank->getBank()->getNumPresets());
 }
 
 int SimpleEQAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return currentProgram;
 }
 
 void SimpleEQAudioProcessor::setCurrentProgram (int index)
 {
+    // Holding the bank keeps the preset's pages mapped while it's read.
+    auto bank = presetBank->getBank();
+    auto state = bank->getState (index);
+
+    if (state.data == nullptr)
+        return;
+
+    // The state is the same binary block as a saved session, read straight
+    // out of the mapped file. All of it goes to the audio thread as a single
+    // change, which is crossfaded in.
+    auto loaded = false;
+    coefficientPublisher.applyChange ([&] { loaded = readParameterState (*this, state.data, state.size); });
+
+    if (loaded)
+        currentProgram = index;
 }
 
 const juce::String SimpleEQAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return presetBank->getBank()->getName (index);
 }
 
 void SimpleEQAudioProcessor::changeProgramName (int index, const juce::String& newName)
 {
+    // Presets are renamed by saving them again under the new name.
+    juce::ignoreUnused (index, newName);
+}
+
+bool SimpleEQAudioProcessor::saveUserPreset (const juce::String& name)
+{
+    juce::MemoryBlock state;
+    writeParameterState (*this, state);
+
+    auto index = presetBank->saveUserPreset (name, state);
+
+    if (index < 0)
+        return false;
+
+    currentProgram = index;
+    updateHostDisplay (ChangeDetails().withProgramChanged (true));
+    return true;
 }
 
 //==============================================================================
+template <typename SampleType>
+static void createOversamplers (juce::OwnedArray<juce::dsp::Oversampling<SampleType>>& oversamplers,
+                                int numChannels, int maximumBlockSize)
+{
+    using Oversampling = juce::dsp::Oversampling<SampleType>;
+
+    oversamplers.clear();
+
+    // In the order getOversamplerIndex() expects: 2x, 4x, 8x, each as IIR then FIR.
+    for (size_t order = 1; order <= 3; ++order)
+    {
+        for (auto type : { Oversampling::filterHalfBandPolyphaseIIR, Oversampling::filterHalfBandFIREquiripple })
+        {
+            auto* oversampling = oversamplers.add (new Oversampling ((size_t) numChannels, order, type, true, true));
+            oversampling->initProcessing ((size_t) maximumBlockSize);
+        }
+    }
+}
+
+void SimpleEQAudioProcessor::setSubBlockSize (int numSamples)
+{
+    jassert (numSamples >= 0);
+    requestedSubBlockSize = juce::jmax (0, numSamples);
+}
+
 void SimpleEQAudioProcessor::prepareToPlay (double sampleRate, int samplesPerBlock)
 {
-    // Use this method as the place to do any pre-playback
-    // initialisation that you need..
+    crossfadeLength = juce::roundToInt (sampleRate * stageCrossfadeSeconds);
+    silentSamples = 0;
+    sleeping = false;
+
+    // Nothing past the sub-block scheduler ever sees more than one sub-block.
+    subBlockSize = requestedSubBlockSize;
+    subBlockPosition = 0;
+    maxBlockSize = subBlockSize > 0 ? juce::jmin (samplesPerBlock, subBlockSize) : samplesPerBlock;
+    oversamplingFactor = 1;
+    activeOversampler = -1;
+    svfActive = false;
+
+    auto numChannels = juce::jmax (1, getTotalNumInputChannels());
+    auto updateInterval = subBlockSize > 0 ? subBlockSize : defaultSubBlockSize;
+
+    if (isUsingDoublePrecision())
+    {
+        doubleChain.prepare (numChannels, crossfadeLength, updateInterval);
+        doubleSvf.prepare (numChannels, updateInterval);
+        createOversamplers (doubleOversamplers, numChannels, maxBlockSize);
+        floatOversamplers.clear();
+    }
+    else
+    {
+        floatChain.prepare (numChannels, crossfadeLength, updateInterval);
+        floatSvf.prepare (numChannels, updateInterval);
+        createOversamplers (floatOversamplers, numChannels, maxBlockSize);
+        doubleOversamplers.clear();
+    }
+
+    // The partition size only changes here, as the convolution has to be rebuilt.
+    auto partition = (int) parameters.read()[ParameterSnapshot::lowCutPartition];
+    linearPhaseLowCut.prepare (sampleRate, maxBlockSize, getTotalNumInputChannels(),
+                               LinearPhaseLowCut::partitionSizes[(size_t) partition]);
+    linearPhaseActive = false;
+    updateLatency();
+
+    // Enough for the analyzer to fall a few of its time slices behind.
+    auto analyzerCapacity = juce::jmax (4 * samplesPerBlock, juce::roundToInt (sampleRate * 0.1));
+    preFilterFifo.prepare (getTotalNumInputChannels(), analyzerCapacity);
+    postFilterFifo.prepare (getTotalNumInputChannels(), analyzerCapacity);
+
+    PROCESS_PROFILER_PREPARE (profiler, sampleRate);
+
+    // The first block will pick these up from the publisher.
+    coefficientPublisher.prepare (sampleRate);
 }
 
 void SimpleEQAudioProcessor::releaseResources()
@@ -103,6 +220,25 @@ void SimpleEQAudioProcessor::releaseResources()
     // spare memory, etc.
 }
 
+void SimpleEQAudioProcessor::reset()
+{
+    floatChain.reset();
+    doubleChain.reset();
+    floatSvf.reset();
+    doubleSvf.reset();
+    linearPhaseLowCut.reset();
+
+    for (auto* oversampling : floatOversamplers)
+        oversampling->reset();
+
+    for (auto* oversampling : doubleOversamplers)
+        oversampling->reset();
+
+    silentSamples = 0;
+    sleeping = false;
+    subBlockPosition = 0;
+}
+
 #ifndef JucePlugin_PreferredChannelConfigurations
 bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts) const
 {
@@ -110,12 +246,9 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Every channel gets the same filter, so any discrete, surround or
+    // ambisonic layout will do, as long as there is something to process.
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -130,10 +263,107 @@ bool SimpleEQAudioProcessor::isBusesLayoutSupported (const BusesLayout& layouts)
 #endif
 
 void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
+{
+    PROCESS_PROFILE_BLOCK (profiler, buffer.getNumSamples());
+
+    pushToAnalyzer (preFilterFifo, buffer);
+    processWithControllers (buffer, midiMessages);
+    pushToAnalyzer (postFilterFifo, buffer);
+}
+
+void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<double>& buffer, juce::MidiBuffer& midiMessages)
+{
+    PROCESS_PROFILE_BLOCK (profiler, buffer.getNumSamples());
+
+    pushToAnalyzer (preFilterFifo, buffer);
+    processWithControllers (buffer, midiMessages);
+    pushToAnalyzer (postFilterFifo, buffer);
+}
+
+bool SimpleEQAudioProcessor::supportsDoublePrecisionProcessing() const
+{
+    return true;
+}
+
+//==============================================================================
+void SimpleEQAudioProcessor::parameterChanged (const juce::String&, float)
+{
+    // This can arrive on any thread, and hosts expect latency changes to come
+    // from the message thread.
+    triggerAsyncUpdate();
+}
+
+void SimpleEQAudioProcessor::handleAsyncUpdate()
+{
+    updateLatency();
+}
+
+void SimpleEQAudioProcessor::updateLatency()
+{
+    setLatencySamples (getOversamplingLatency()
+                        + (isLinearPhaseLowCut() ? linearPhaseLowCut.getLatencySamples() : 0));
+}
+
+int SimpleEQAudioProcessor::getOversamplingLatency() const
+{
+    auto snapshot = parameters.read();
+    auto factor = 1 << (int) snapshot[ParameterSnapshot::oversampling];
+
+    if (factor == 1)
+        return 0;
+
+    auto index = getOversamplerIndex (factor, snapshot[ParameterSnapshot::oversamplingFilter] >= 0.5f);
+
+    // Both sets use the same filters, so either will do for the latency.
+    if (auto* oversampling = floatOversamplers[index])
+        return juce::roundToInt (oversampling->getLatencyInSamples());
+
+    if (auto* oversampling = doubleOversamplers[index])
+        return juce::roundToInt (oversampling->getLatencyInSamples());
+
+    return 0;
+}
+
+int SimpleEQAudioProcessor::getOversamplerIndex (int factor, bool linearPhase) noexcept
+{
+    jassert (juce::isPowerOfTwo (factor) && factor >= 2 && factor <= 8);
+    return 2 * (juce::findHighestSetBit ((juce::uint32) factor) - 1) + (linearPhase ? 1 : 0);
+}
+
+template <typename SampleType>
+juce::dsp::Oversampling<SampleType>* SimpleEQAudioProcessor::selectOversampler() noexcept
+{
+    auto linearPhase = parameters.get()[ParameterSnapshot::oversamplingFilter] >= 0.5f;
+    auto index = oversamplingFactor > 1 ? getOversamplerIndex (oversamplingFactor, linearPhase) : -1;
+
+    if (index != activeOversampler)
+    {
+        // Start the newly chosen one from silence.
+        if (auto* oversampling = getOversamplers<SampleType>()[index])
+            oversampling->reset();
+
+        activeOversampler = index;
+    }
+
+    return getOversamplers<SampleType>()[index];
+}
+
+bool SimpleEQAudioProcessor::isLinearPhaseLowCut() const noexcept
+{
+    return parameters.read()[ParameterSnapshot::lowCutMode] >= 0.5f;
+}
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::pushToAnalyzer (AnalyzerFifo& fifo, const juce::AudioBuffer<SampleType>& buffer) noexcept
+{
+    PROCESS_PROFILE_STAGE (profiler, profileAnalyzer);
+    fifo.push (buffer, getTotalNumInputChannels());
+}
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::processWithControllers (juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
-    auto totalNumInputChannels  = getTotalNumInputChannels();
-    auto totalNumOutputChannels = getTotalNumOutputChannels();
 
     // In case we have more outputs than inputs, this code clears any output
     // channels that didn't contain input data, (because these aren't
@@ -141,20 +371,281 @@ void SimpleEQAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juc
     // This is here to avoid people getting screaming feedback
     // when they first compile a plugin, but obviously you don't need to keep
     // this code if your algorithm always overwrites all the output channels.
-    for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
+    for (auto i = getTotalNumInputChannels(); i < getTotalNumOutputChannels(); ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-    // This is the place where you'd normally do the guts of your plugin's
-    // audio processing...
-    // Make sure to reset the state if your inner loop is processing
-    // the samples and the outer loop is handling the channels.
-    // Alternatively, you can process the samples with the channels
-    // interleaved by keeping the same state.
-    for (int channel = 0; channel < totalNumInputChannels; ++channel)
+    // The block is split wherever a controller moves a filter, so each change
+    // takes effect on its own sample.
+    controllers.process (midiMessages, buffer.getNumSamples(),
+                         [this] (int slot, float value) { applyControllerChange<SampleType> (slot, value); },
+                         [this, &buffer] (int start, int length) { processSubBlocks (buffer, start, length); });
+}
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::processSubBlocks (juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples)
+{
+    // A host block of 1 sample and one of 8192 both come down to the same
+    // sub-blocks, so the work per sample, and what's in cache while it's
+    // done, stays the same. The grid carries on across host blocks and
+    // controller events; they only cut a sub-block short.
+    while (numSamples > 0)
     {
-        auto* channelData = buffer.getWritePointer (channel);
+        // The parameters are only looked at where a sub-block starts.
+        if (subBlockPosition == 0)
+        {
+            parameters.update();
+            pullCoefficients<SampleType>();
+            updateFilterEngine<SampleType>();
+        }
 
-        // ..do something to the data...
+        auto length = subBlockSize > 0 ? juce::jmin (numSamples, subBlockSize - subBlockPosition) : numSamples;
+
+        // A block refers to the buffer's own channels, so nothing is copied
+        // or allocated, however many channels there are.
+        process (juce::dsp::AudioBlock<SampleType> (buffer).getSubBlock ((size_t) startSample, (size_t) length));
+
+        startSample += length;
+        numSamples -= length;
+        subBlockPosition = subBlockSize > 0 ? (subBlockPosition + length) % subBlockSize : 0;
+    }
+}
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::applyControllerChange (int slot, float value) noexcept
+{
+    PROCESS_PROFILE_STAGE (profiler, profileCoefficients);
+
+    // Start from the parameters, unless they haven't caught up with earlier
+    // controller changes yet. Until they have, nothing new is pulled, so the
+    // rate and mode stay put and only the band this slot belongs to has to
+    // be designed again.
+    auto changed = ParameterSnapshot::bit (slot);
+
+    if (! controllerChangesPending)
+    {
+        controllerSettings = coefficientPublisher.readSettings();
+        changed = ParameterSnapshot::allParameters;
+    }
+
+    coefficientPublisher.applyControllerChange (controllerSettings, slot, value);
+    controllerChangesPending = true;
+
+    // Designed here rather than on the design thread, for the rate and mode
+    // the chain is running in right now.
+    auto settings = controllerSettings;
+    settings.oversamplingFactor = oversamplingFactor;
+    settings.linearPhaseLowCut = linearPhaseActive;
+
+    CoefficientPublisher::designBands (settings, getSampleRate() * oversamplingFactor, nullptr, changed, controllerBands);
+
+    auto coefficients = CoefficientPublisher::makeChain (controllerBands, settings);
+    getChain<SampleType>().setCoefficients (coefficients);
+    tailLengthSamples = coefficients.tailLengthSamples / oversamplingFactor;
+
+    // The SVF glides there from wherever it is. The chain is kept up to date
+    // too, so that switching back to it doesn't lose the change.
+    if (svfActive)
+        getSvf<SampleType>().setSettings (settings, getSampleRate() * oversamplingFactor);
+}
+
+template <typename SampleType>
+static bool isSilent (const juce::dsp::AudioBlock<SampleType>& block, int numChannels, SampleType threshold) noexcept
+{
+    for (int ch = 0; ch < numChannels; ++ch)
+    {
+        auto range = juce::FloatVectorOperations::findMinAndMax (block.getChannelPointer ((size_t) ch),
+                                                                 (int) block.getNumSamples());
+
+        if (juce::jmax (-range.getStart(), range.getEnd()) > threshold)
+            return false;
+    }
+
+    return true;
+}
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::pullCoefficients() noexcept
+{
+    auto& chain = getChain<SampleType>();
+
+    // Coefficients are designed on a background thread; all we do here is
+    // copy the latest ready-made set, if there is one. Sets designed before
+    // the parameters had caught up with the controllers would undo them.
+    auto* coefficients = coefficientPublisher.pullNewCoefficients();
+
+    if (coefficients != nullptr && coefficients->controllerSequence != coefficientPublisher.getControllerSequence())
+        coefficients = nullptr;
+
+    if (coefficients != nullptr)
+    {
+        PROCESS_PROFILE_STAGE (profiler, profileCoefficients);
+
+        controllerChangesPending = false;
+
+        // Coefficients for another rate mean the oversampling factor has
+        // changed. The old state means nothing at the new rate, so the chain
+        // starts again from silence.
+        if (coefficients->oversamplingFactor != oversamplingFactor)
+        {
+            oversamplingFactor = coefficients->oversamplingFactor;
+            auto updateInterval = (subBlockSize > 0 ? subBlockSize : defaultSubBlockSize) * oversamplingFactor;
+
+            chain.reset();
+            chain.setTimings (crossfadeLength * oversamplingFactor, updateInterval);
+
+            getSvf<SampleType>().reset();
+            getSvf<SampleType>().setGlideLength (updateInterval);
+            svfChanges = ParameterSnapshot::allParameters;
+        }
+
+        chain.setCoefficients (*coefficients);
+        tailLengthSamples = coefficients->tailLengthSamples / oversamplingFactor;
+
+        // Start the convolution from silence rather than from whatever it
+        // last heard before it was switched off.
+        if (coefficients->linearPhaseLowCut && ! linearPhaseActive)
+            linearPhaseLowCut.reset();
+
+        // The SVF's LowCut sections fade out or back in to match.
+        if (coefficients->linearPhaseLowCut != linearPhaseActive)
+            svfChanges |= ParameterSnapshot::lowCutBand;
+
+        linearPhaseActive = coefficients->linearPhaseLowCut;
+    }
+}
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::updateFilterEngine() noexcept
+{
+    auto& snapshot = parameters.get();
+    auto& svf = getSvf<SampleType>();
+
+    // For the rate and mode the chain is running in right now.
+    auto setSvfSettings = [this, &svf] (FilterSettings settings)
+    {
+        settings.oversamplingFactor = oversamplingFactor;
+        settings.linearPhaseLowCut = linearPhaseActive;
+        svf.setSettings (settings, getSampleRate() * oversamplingFactor);
+    };
+
+    auto useSvf = snapshot[ParameterSnapshot::filterEngine] >= 0.5f;
+
+    if (useSvf != svfActive)
+    {
+        // Neither engine's state means anything to the other, so whichever
+        // takes over starts from silence, as it does when the rate changes.
+        getChain<SampleType>().reset();
+        svf.reset();
+        svfActive = useSvf;
+        svfChanges = ParameterSnapshot::allParameters;
+
+        if (svfActive && controllerChangesPending)
+            setSvfSettings (controllerSettings);
+    }
+
+    if (! svfActive)
+        return;
+
+    // Until the parameters have caught up with the controllers, the SVF
+    // stays where applyControllerChange() put it, and whatever has moved in
+    // the meantime is kept for when they have.
+    svfChanges |= snapshot.changed;
+
+    if (controllerChangesPending
+         || (svfChanges & (ParameterSnapshot::lowCutBand | ParameterSnapshot::peakBand | ParameterSnapshot::highCutBand)) == 0)
+        return;
+
+    // The SVF works from the settings directly, so a parameter that moves
+    // every sub-block just glides, with nothing designed anywhere else.
+    PROCESS_PROFILE_STAGE (profiler, profileCoefficients);
+    setSvfSettings (snapshot.getFilterSettings());
+    svfChanges = 0;
+}
+
+template <typename SampleType>
+void SimpleEQAudioProcessor::process (const juce::dsp::AudioBlock<SampleType>& block)
+{
+    auto totalNumInputChannels = getTotalNumInputChannels();
+    auto& chain = getChain<SampleType>();
+    auto& svf = getSvf<SampleType>();
+    auto* oversampler = selectOversampler<SampleType>();
+
+    auto filter = [&] (const juce::dsp::AudioBlock<SampleType>& samples)
+    {
+        if (svfActive)
+            svf.process (samples, totalNumInputChannels);
+        else
+            chain.process (samples, totalNumInputChannels);
+    };
+
+    // The oversampler and the linear-phase LowCut always run, even when they
+    // only delay the signal, so the latency the host compensates for stays true.
+    if ((svfActive ? svf.isNeutral() : chain.isNeutral()) && ! linearPhaseActive && oversampler == nullptr)
+        return;
+
+    // A vectorised min/max scan of each channel, which stops at the first one
+    // that has signal in it.
+    auto silent = isSilent (block, totalNumInputChannels, (SampleType) silenceThreshold);
+
+    if (! silent)
+    {
+        silentSamples = 0;
+        sleeping = false;
+    }
+    else if (sleeping)
+    {
+        // Anything left in the buffer is below the threshold, so passing it
+        // through unfiltered is inaudible.
+        return;
+    }
+
+    // The channels are filtered together, one per SIMD lane.
+    if (oversampler != nullptr)
+    {
+        PROCESS_PROFILE_STAGE (profiler, profileFilters);
+
+        auto inputs = block.getSubsetChannelBlock (0, (size_t) totalNumInputChannels);
+
+        // The oversampler was only prepared for blocks of up to maxBlockSize.
+        for (size_t start = 0; start < inputs.getNumSamples(); start += (size_t) maxBlockSize)
+        {
+            auto subBlock = inputs.getSubBlock (start, juce::jmin ((size_t) maxBlockSize, inputs.getNumSamples() - start));
+
+            filter (oversampler->processSamplesUp (subBlock));
+            oversampler->processSamplesDown (subBlock);
+        }
+    }
+    else
+    {
+        PROCESS_PROFILE_STAGE (profiler, profileFilters);
+        filter (block);
+    }
+
+    if (linearPhaseActive)
+    {
+        PROCESS_PROFILE_STAGE (profiler, profileLinearPhase);
+        linearPhaseLowCut.process (block, totalNumInputChannels);
+    }
+
+    if (silent)
+    {
+        silentSamples = juce::jmin (silentSamples + (int) block.getNumSamples(), std::numeric_limits<int>::max() / 2);
+
+        auto tail = tailLengthSamples + (linearPhaseActive ? linearPhaseLowCut.getTailLengthSamples() : 0);
+
+        if (silentSamples > tail + crossfadeLength)
+        {
+            // The tail has died away: clear whatever residue is left in the
+            // state, so the filter wakes up clean rather than from denormals.
+            chain.reset();
+            svf.reset();
+            linearPhaseLowCut.reset();
+
+            if (oversampler != nullptr)
+                oversampler->reset();
+
+            sleeping = true;
+        }
     }
 }
 
@@ -166,22 +657,21 @@ bool SimpleEQAudioProcessor::hasEditor() const
 
 juce::AudioProcessorEditor* SimpleEQAudioProcessor::createEditor()
 {
-    return new juce::GenericAudioProcessorEditor(*this);
-    //return new SimpleEQAudioProcessorEditor (*this);
+    return new SimpleEQAudioProcessorEditor (*this);
 }
 
 //==============================================================================
 void SimpleEQAudioProcessor::getStateInformation (juce::MemoryBlock& destData)
 {
-    // You should use this method to store your parameters in the memory block.
-    // You could do that either as raw data, or use the XML or ValueTree classes
-    // as intermediaries to make it easy to save and load complex data.
+    // A compact binary block rather than the XML round trip; see ParameterState.h.
+    writeParameterState (*this, destData);
 }
 
 void SimpleEQAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
-    // You should use this method to restore your parameters from this memory block,
-    // whose contents will have been created by the getStateInformation() call.
+    // Data that isn't a valid state leaves the parameters as they are. As with
+    // a program change, all of it reaches the audio thread as a single change.
+    coefficientPublisher.applyChange ([&] { readParameterState (*this, data, sizeInBytes); });
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::createParameterLayout()
@@ -190,13 +680,13 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
     
     layout.add(std::make_unique<juce::AudioParameterFloat>("LowCut Freq", "LowCut Freq", juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f,  1.0f), 20.0f ));
     
-//    layout.add(std::make_unique<juce::AudioParameterFloat>("HighCut Freq", "HighCut Freq", juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f,  1.0f), 20000.0f ));
-//    
-//    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Freq", "Peak Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.0f,  1.0f), 750.0f ));
-//    
-//    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Gain", "Peak Gain", juce::NormalisableRange<float>(-24.0f, 24.0f, 0.5f,  1.0f), 0.0f ));
-//    
-//    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Quality", "Peak Quality", juce::NormalisableRange<float>(0.1f, 10.0f, 0.05f,  1.0f), 0.0f ));
+    layout.add(std::make_unique<juce::AudioParameterFloat>("HighCut Freq", "HighCut Freq", juce::NormalisableRange<float>(20.0f, 20000.0f, 1.0f,  1.0f), 20000.0f ));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Freq", "Peak Freq", juce::NormalisableRange<float>(20.f, 20000.f, 1.0f,  1.0f), 750.0f ));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Gain", "Peak Gain", juce::NormalisableRange<float>(-24.0f, 24.0f, 0.5f,  1.0f), 0.0f ));
+    
+    layout.add(std::make_unique<juce::AudioParameterFloat>("Peak Quality", "Peak Quality", juce::NormalisableRange<float>(0.1f, 10.0f, 0.05f,  1.0f), 1.0f ));
     
     juce::StringArray stringArray;
     
@@ -208,7 +698,37 @@ juce::AudioProcessorValueTreeState::ParameterLayout SimpleEQAudioProcessor::crea
     }
     
     layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope", "LowCut Slope", stringArray, 0));
-    //layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", stringArray, 0));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", stringArray, 0));
+    
+    // Switching mode changes the latency, so neither of these can be automated.
+    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Mode", "LowCut Mode", juce::StringArray { "Minimum Phase", "Linear Phase" }, 0,
+                                                            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+    
+    juce::StringArray partitionArray;
+    
+    for(auto size : LinearPhaseLowCut::partitionSizes){
+        juce::String str;
+        str << size;
+        str << " samples";
+        partitionArray.add(str);
+    }
+    
+    // Takes effect the next time playback is prepared.
+    layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Partition", "LowCut Partition", partitionArray, 2,
+                                                            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+    
+    // Running the filters at a multiple of the sample rate keeps high cutoffs
+    // from being squashed towards Nyquist. Both change the latency.
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling", "Oversampling", juce::StringArray { "Off", "2x", "4x", "8x" }, 0,
+                                                            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling Filter", "Oversampling Filter",
+                                                            juce::StringArray { "IIR (Minimum Latency)", "FIR (Linear Phase)" }, 0,
+                                                            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
+    
+    // The same responses either way. The state-variable filters are built to
+    // be modulated: their settings glide sample by sample without clicks.
+    layout.add(std::make_unique<juce::AudioParameterChoice>("Filter Engine", "Filter Engine", juce::StringArray { "Biquad", "State Variable" }, 0,
+                                                            juce::AudioParameterChoiceAttributes().withAutomatable(false)));
     
     return layout;
 }
@@ -9,6 +9,14 @@
 #pragma once
 
 #include <JuceHeader.h>
+#include "BiquadCascade.h"
+#include "SvfCascade.h"
+#include "CoefficientPublisher.h"
+#include "LinearPhaseLowCut.h"
+#include "AnalyzerFifo.h"
+#include "PresetBank.h"
+#include "../../Shared/ProcessProfiler.h"
+#include "../../Shared/ControllerAutomation.h"
 
 //==============================================================================
 /**
@@ -17,6 +25,8 @@ class SimpleEQAudioProcessor  : public juce::AudioProcessor
                             #if JucePlugin_Enable_ARA
                              , public juce::AudioProcessorARAExtension
                             #endif
+                             , private juce::AudioProcessorValueTreeState::Listener,
+                               private juce::AsyncUpdater
 {
 public:
     //==============================================================================
@@ -27,11 +37,18 @@ public:
     void prepareToPlay (double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
 
+    /** Clears everything the filters remember of the audio so far, so that
+        the next block starts from silence with the current settings.
+    */
+    void reset() override;
+
    #ifndef JucePlugin_PreferredChannelConfigurations
     bool isBusesLayoutSupported (const BusesLayout& layouts) const override;
    #endif
 
     void processBlock (juce::AudioBuffer<float>&, juce::MidiBuffer&) override;
+    void processBlock (juce::AudioBuffer<double>&, juce::MidiBuffer&) override;
+    bool supportsDoublePrecisionProcessing() const override;
 
     //==============================================================================
     juce::AudioProcessorEditor* createEditor() override;
@@ -56,9 +73,174 @@ public:
     void getStateInformation (juce::MemoryBlock& destData) override;
     void setStateInformation (const void* data, int sizeInBytes) override;
 
+    //==============================================================================
+    /** Switches the process-wide coefficient lookup table on or off (it's on by default). */
+    void setUseCoefficientTable (bool shouldUseTable)    { coefficientPublisher.setUseCoefficientTable (shouldUseTable); }
+
+    /** The memory used by the coefficient tables, shared by every instance in the process. */
+    size_t getCoefficientTableMemoryFootprint()          { return coefficientPublisher.getCoefficientTableMemoryFootprint(); }
+
+    /** Sets the size of the sub-blocks that processing is split into, whatever
+        size of block the host passes in, or 0 to process the host's blocks
+        whole. Takes effect from the next prepareToPlay().
+    */
+    void setSubBlockSize (int numSamples);
+
+    static constexpr int defaultSubBlockSize = 64;
+
+    /** Saves the current settings as a user preset in the shared bank, and
+        makes it the current program. Returns false if the name belongs to a
+        factory preset or the bank couldn't be written.
+    */
+    bool saveUserPreset (const juce::String& name);
+
+    /** The audio going into and coming out of the filters, for the spectrum analyzer. */
+    AnalyzerFifo& getPreFilterFifo() noexcept            { return preFilterFifo; }
+    AnalyzerFifo& getPostFilterFifo() noexcept           { return postFilterFifo; }
+
+   #if PROCESS_PROFILER_ENABLED
+    /** Timings of processBlock and its stages. */
+    ProcessProfiler& getProfiler() noexcept              { return profiler; }
+   #endif
+
     static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout();
     juce::AudioProcessorValueTreeState apvts {*this, nullptr, "Parameters", createParameterLayout()};
 private:
+    //==============================================================================
+    template <typename SampleType>
+    void processWithControllers (juce::AudioBuffer<SampleType>& buffer, const juce::MidiBuffer& midiMessages);
+
+    template <typename SampleType>
+    void applyControllerChange (int slot, float value) noexcept;
+
+    template <typename SampleType>
+    void processSubBlocks (juce::AudioBuffer<SampleType>& buffer, int startSample, int numSamples);
+
+    template <typename SampleType>
+    void pullCoefficients() noexcept;
+
+    template <typename SampleType>
+    void updateFilterEngine() noexcept;
+
+    template <typename SampleType>
+    void process (const juce::dsp::AudioBlock<SampleType>& block);
+
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+    void updateLatency();
+    bool isLinearPhaseLowCut() const noexcept;
+
+    template <typename SampleType>
+    BiquadCascade<SampleType>& getChain() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+            return floatChain;
+        else
+            return doubleChain;
+    }
+
+    template <typename SampleType>
+    SvfCascade<SampleType>& getSvf() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+            return floatSvf;
+        else
+            return doubleSvf;
+    }
+
+    template <typename SampleType>
+    juce::OwnedArray<juce::dsp::Oversampling<SampleType>>& getOversamplers() noexcept
+    {
+        if constexpr (std::is_same_v<SampleType, float>)
+            return floatOversamplers;
+        else
+            return doubleOversamplers;
+    }
+
+    template <typename SampleType>
+    juce::dsp::Oversampling<SampleType>* selectOversampler() noexcept;
+
+    template <typename SampleType>
+    void pushToAnalyzer (AnalyzerFifo& fifo, const juce::AudioBuffer<SampleType>& buffer) noexcept;
+
+    int getOversamplingLatency() const;
+    static int getOversamplerIndex (int factor, bool linearPhase) noexcept;
+
+    // How long filter stages take to fade in or out when they're switched.
+    static constexpr double stageCrossfadeSeconds = 0.02;
+
+    // Input quieter than this (-120 dBFS) counts as silence.
+    static constexpr float silenceThreshold = 1.0e-6f;
+
+    CoefficientPublisher coefficientPublisher { apvts };
+
+    // MIDI CC 20 to 26 move the filter parameters, in the order of
+    // ParameterSnapshot's indices, at the sample they arrive on.
+    static constexpr int firstController = 20;
+    ControllerAutomation controllers;
+
+    // Audio thread only: the settings the controllers have moved the filters
+    // to, and the bands designed from them, kept until the parameters have
+    // caught up.
+    FilterSettings controllerSettings;
+    BandCoefficients controllerBands;
+    bool controllerChangesPending = false;
+
+    // Taken at the start of each sub-block, on the audio thread. Other
+    // threads use read().
+    ParameterSnapshotReader parameters { apvts };
+
+    // Only the one matching the host's processing precision is in use.
+    BiquadCascade<float>  floatChain;
+    BiquadCascade<double> doubleChain;
+
+    // The state-variable engine, which runs instead of the chain when "Filter
+    // Engine" selects it. It's given the settings themselves rather than the
+    // published coefficients, and glides to them across each sub-block.
+    // svfChanges gathers the parameters that have moved since it was last
+    // given them. Audio thread only.
+    SvfCascade<float>  floatSvf;
+    SvfCascade<double> doubleSvf;
+    bool svfActive = false;
+    juce::uint32 svfChanges = 0;
+
+    // Every factor and filter type is built in prepareToPlay(), so switching
+    // between them never allocates. Only the ones for the processing
+    // precision in use are kept.
+    juce::OwnedArray<juce::dsp::Oversampling<float>>  floatOversamplers;
+    juce::OwnedArray<juce::dsp::Oversampling<double>> doubleOversamplers;
+
+    // Audio thread only: the rate the chain runs at, as a multiple of the
+    // host's, and the oversampler in use, or -1 for none.
+    int oversamplingFactor = 1, activeOversampler = -1, maxBlockSize = 0;
+
+    // Blocks are processed in sub-blocks of a fixed size, on a grid that runs
+    // on from one block to the next, so the cost per sample and the points at
+    // which new coefficients are picked up don't depend on the host.
+    // subBlockSize is only changed in prepareToPlay().
+    int requestedSubBlockSize = defaultSubBlockSize, subBlockSize = defaultSubBlockSize;
+    int subBlockPosition = 0;   // audio thread only
+
+    // Only filled while an editor is showing the analyzer.
+    AnalyzerFifo preFilterFifo, postFilterFifo;
+
+    // The stages timed when the profiler is built in, in the order they're named below.
+    enum ProfileStage { profileBlock, profileAnalyzer, profileCoefficients, profileFilters, profileLinearPhase };
+    PROCESS_PROFILER_MEMBER (profiler, { "processBlock", "analyzer", "coefficients", "filters", "linear phase" })
+
+    // Programs are the presets in the bank, which every instance shares.
+    juce::SharedResourcePointer<SharedPresetBank> presetBank;
+    int currentProgram = 0;
+
+    // Runs after the chain while the LowCut is in linear-phase mode.
+    LinearPhaseLowCut linearPhaseLowCut { apvts };
+    bool linearPhaseActive = false;
+
+    // Audio thread only: once the input has been silent for longer than the
+    // filters ring, processing stops until signal comes back.
+    int tailLengthSamples = 0, crossfadeLength = 0, silentSamples = 0;
+    bool sleeping = false;
+
     //==============================================================================
     JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SimpleEQAudioProcessor)
 };
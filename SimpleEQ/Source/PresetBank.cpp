@@ -0,0 +1,388 @@
+/*
+  ==============================================================================
+
+    PresetBank.cpp
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+#include "ParameterState.h"
+
+//==============================================================================
+static constexpr juce::uint32 bankMagic = 0x42514553;      // "SEQB" in file order
+static constexpr juce::uint16 bankVersion = 1;
+static constexpr int headerSize = 32;
+static constexpr int currentRecordSize = 16;
+static constexpr juce::uint32 factoryFlag = 1;
+
+static void writeUInt16 (char* dest, juce::uint16 value) noexcept
+{
+    value = juce::ByteOrder::swapIfBigEndian (value);
+    std::memcpy (dest, &value, sizeof (value));
+}
+
+static void writeUInt32 (char* dest, juce::uint32 value) noexcept
+{
+    value = juce::ByteOrder::swapIfBigEndian (value);
+    std::memcpy (dest, &value, sizeof (value));
+}
+
+//==============================================================================
+PresetBank::PresetBank (const juce::File& file)
+{
+    if (! file.existsAsFile())
+        return;
+
+    mappedFile = std::make_unique<juce::MemoryMappedFile> (file, juce::MemoryMappedFile::readOnly);
+    open (static_cast<const char*> (mappedFile->getData()), mappedFile->getSize());
+}
+
+PresetBank::PresetBank (juce::MemoryBlock bankData)
+    : ownedData (std::move (bankData))
+{
+    open (static_cast<const char*> (ownedData.getData()), ownedData.getSize());
+}
+
+void PresetBank::open (const char* header, size_t size)
+{
+    if (header == nullptr || size < (size_t) headerSize)
+        return;
+
+    auto count          = juce::ByteOrder::littleEndianInt (header + 8);
+    auto slots          = juce::ByteOrder::littleEndianInt (header + 12);
+    auto records        = juce::ByteOrder::littleEndianInt (header + 16);
+    auto slotTable      = juce::ByteOrder::littleEndianInt (header + 20);
+    auto storedRecord   = (int) juce::ByteOrder::littleEndianShort (header + 6);
+
+    // Only the header is checked here; each record is checked as it's used,
+    // so that opening the bank never reads the rest of the file.
+    if (juce::ByteOrder::littleEndianInt (header) != bankMagic
+         || juce::ByteOrder::littleEndianShort (header + 4) == 0
+         || juce::ByteOrder::littleEndianInt (header + 24) != size
+         || storedRecord < currentRecordSize
+         || ! juce::isPowerOfTwo (slots) || slots < 2 * count
+         || records > size || count > (size - records) / (size_t) storedRecord
+         || slotTable > size || slots > (size - slotTable) / 4)
+        return;
+
+    data = header;
+    dataSize = size;
+    numPresets = (int) count;
+    recordSize = storedRecord;
+    numSlots = slots;
+    recordsOffset = records;
+    slotsOffset = slotTable;
+}
+
+bool PresetBank::readRecord (int index, Record& record) const noexcept
+{
+    if (! juce::isPositiveAndBelow (index, numPresets))
+        return false;
+
+    auto* r = data + recordsOffset + (size_t) index * (size_t) recordSize;
+
+    record.nameOffset  = juce::ByteOrder::littleEndianInt (r);
+    record.nameLength  = juce::ByteOrder::littleEndianShort (r + 4);
+    record.flags       = juce::ByteOrder::littleEndianShort (r + 6);
+    record.stateOffset = juce::ByteOrder::littleEndianInt (r + 8);
+    record.stateSize   = juce::ByteOrder::littleEndianInt (r + 12);
+
+    return record.nameOffset <= dataSize && record.nameLength <= dataSize - record.nameOffset
+        && record.stateOffset <= dataSize && record.stateSize <= dataSize - record.stateOffset;
+}
+
+juce::String PresetBank::getName (int index) const
+{
+    Record record;
+
+    if (! readRecord (index, record))
+        return {};
+
+    return juce::String::fromUTF8 (data + record.nameOffset, (int) record.nameLength);
+}
+
+bool PresetBank::isFactoryPreset (int index) const noexcept
+{
+    Record record;
+    return readRecord (index, record) && (record.flags & factoryFlag) != 0;
+}
+
+PresetBank::StateData PresetBank::getState (int index) const noexcept
+{
+    Record record;
+
+    if (! readRecord (index, record))
+        return {};
+
+    return { data + record.stateOffset, (int) record.stateSize };
+}
+
+int PresetBank::indexOf (const juce::String& name) const noexcept
+{
+    if (numSlots == 0)
+        return -1;
+
+    auto* utf8 = name.toRawUTF8();
+    auto length = std::strlen (utf8);
+    auto* slots = data + slotsOffset;
+
+    for (juce::uint32 probe = 0, slot = fnv1a (utf8, length) & (numSlots - 1);
+         probe < numSlots;
+         ++probe, slot = (slot + 1) & (numSlots - 1))
+    {
+        auto entry = juce::ByteOrder::littleEndianInt (slots + 4 * (size_t) slot);
+
+        if (entry == 0)
+            return -1;
+
+        Record record;
+        auto index = (int) entry - 1;
+
+        if (readRecord (index, record) && record.nameLength == length
+             && std::memcmp (data + record.nameOffset, utf8, length) == 0)
+            return index;
+    }
+
+    return -1;
+}
+
+std::vector<PresetBank::Preset> PresetBank::getAllPresets() const
+{
+    std::vector<Preset> presets;
+
+    for (int i = 0; i < numPresets; ++i)
+    {
+        auto state = getState (i);
+        presets.push_back ({ getName (i), juce::MemoryBlock (state.data, (size_t) state.size), isFactoryPreset (i) });
+    }
+
+    return presets;
+}
+
+//==============================================================================
+bool PresetBank::write (const std::vector<Preset>& presets, juce::MemoryBlock& destData)
+{
+    // Names are stored with a 16-bit length.
+    auto getNameLength = [] (const Preset& preset)
+    {
+        return juce::jmin ((size_t) std::numeric_limits<juce::uint16>::max(), preset.name.getNumBytesAsUTF8());
+    };
+
+    auto count = (juce::uint32) presets.size();
+    auto slots = (juce::uint32) juce::nextPowerOfTwo ((int) juce::jmax (1u, 2 * count));
+
+    // Header, records and slots first, then each name followed by its state.
+    auto recordsStart = (size_t) headerSize;
+    auto slotsStart = recordsStart + count * (size_t) currentRecordSize;
+    auto size = slotsStart + slots * (size_t) 4;
+
+    for (auto& preset : presets)
+    {
+        size += getNameLength (preset);
+        size = (size + 3) & ~(size_t) 3;
+        size += preset.state.getSize();
+    }
+
+    if (size > std::numeric_limits<juce::uint32>::max())
+        return false;
+
+    destData.setSize (size, true);
+    auto* base = static_cast<char*> (destData.getData());
+
+    writeUInt32 (base,      bankMagic);
+    writeUInt16 (base + 4,  bankVersion);
+    writeUInt16 (base + 6,  (juce::uint16) currentRecordSize);
+    writeUInt32 (base + 8,  count);
+    writeUInt32 (base + 12, slots);
+    writeUInt32 (base + 16, (juce::uint32) recordsStart);
+    writeUInt32 (base + 20, (juce::uint32) slotsStart);
+    writeUInt32 (base + 24, (juce::uint32) size);
+
+    auto position = slotsStart + slots * (size_t) 4;
+
+    for (juce::uint32 i = 0; i < count; ++i)
+    {
+        auto& preset = presets[i];
+        auto* utf8 = preset.name.toRawUTF8();
+        auto nameLength = getNameLength (preset);
+
+        auto nameOffset = position;
+        std::memcpy (base + position, utf8, nameLength);
+        position = (position + nameLength + 3) & ~(size_t) 3;
+
+        auto stateOffset = position;
+        std::memcpy (base + position, preset.state.getData(), preset.state.getSize());
+        position += preset.state.getSize();
+
+        auto* record = base + recordsStart + i * (size_t) currentRecordSize;
+        writeUInt32 (record,      (juce::uint32) nameOffset);
+        writeUInt16 (record + 4,  (juce::uint16) nameLength);
+        writeUInt16 (record + 6,  (juce::uint16) (preset.isFactory ? factoryFlag : 0));
+        writeUInt32 (record + 8,  (juce::uint32) stateOffset);
+        writeUInt32 (record + 12, (juce::uint32) preset.state.getSize());
+
+        // The first preset with a name keeps its slot; a duplicate is still
+        // in the bank but can only be reached by number.
+        for (auto slot = fnv1a (utf8, nameLength) & (slots - 1);; slot = (slot + 1) & (slots - 1))
+        {
+            auto* entry = base + slotsStart + 4 * (size_t) slot;
+            auto existing = juce::ByteOrder::littleEndianInt (entry);
+
+            if (existing == 0)
+            {
+                writeUInt32 (entry, i + 1);
+                break;
+            }
+
+            jassert (presets[existing - 1].name != preset.name);
+
+            if (presets[existing - 1].name == preset.name)
+                break;
+        }
+    }
+
+    jassert (position == size);
+    return true;
+}
+
+std::vector<PresetBank::Preset> PresetBank::getFactoryPresets()
+{
+    struct FactoryPreset
+    {
+        const char* name;
+        float lowCutFreq, lowCutSlope, peakFreq, peakGain, peakQuality, highCutFreq, highCutSlope;
+    };
+
+    // Slopes are choice indices: 0 = 12 dB/Oct up to 3 = 48 dB/Oct. A LowCut at
+    // 20 Hz or a HighCut at 20 kHz is switched off.
+    static const FactoryPreset factoryPresets[] =
+    {
+        { "Flat",                 20.0f, 0.0f,   750.0f,  0.0f, 1.0f, 20000.0f, 0.0f },
+        { "Rumble Filter",        40.0f, 3.0f,   750.0f,  0.0f, 1.0f, 20000.0f, 0.0f },
+        { "Vocal Presence",      100.0f, 1.0f,  3000.0f,  4.0f, 1.0f, 20000.0f, 0.0f },
+        { "Warm Bass",            20.0f, 0.0f,   100.0f,  5.0f, 0.7f, 20000.0f, 0.0f },
+        { "Remove Mud",           60.0f, 1.0f,   300.0f, -4.0f, 1.4f, 20000.0f, 0.0f },
+        { "Telephone",           400.0f, 3.0f,  1500.0f,  6.0f, 1.0f,  3400.0f, 3.0f },
+        { "Air",                  20.0f, 0.0f, 12000.0f,  4.0f, 0.7f, 20000.0f, 0.0f },
+        { "Dark",                 20.0f, 0.0f,   750.0f,  0.0f, 1.0f,  6000.0f, 1.0f },
+        { "Kick Punch",           30.0f, 2.0f,    60.0f,  4.0f, 1.2f, 20000.0f, 0.0f },
+        { "Hi-Hat Cleanup",      300.0f, 2.0f,   750.0f,  0.0f, 1.0f, 20000.0f, 0.0f },
+        { "Narrow Notch 1 kHz",   20.0f, 0.0f,  1000.0f, -24.0f, 10.0f, 20000.0f, 0.0f },
+        { "Band Limit",           80.0f, 1.0f,   750.0f,  0.0f, 1.0f, 16000.0f, 1.0f }
+    };
+
+    std::vector<Preset> presets;
+
+    for (auto& p : factoryPresets)
+    {
+        Preset preset;
+        preset.name = p.name;
+        preset.isFactory = true;
+
+        writeParameterState ({ { "LowCut Freq",   p.lowCutFreq },   { "LowCut Slope",  p.lowCutSlope },
+                               { "Peak Freq",     p.peakFreq },     { "Peak Gain",     p.peakGain },
+                               { "Peak Quality",  p.peakQuality },
+                               { "HighCut Freq",  p.highCutFreq },  { "HighCut Slope", p.highCutSlope } },
+                             preset.state);
+
+        presets.push_back (std::move (preset));
+    }
+
+    return presets;
+}
+
+//==============================================================================
+SharedPresetBank::SharedPresetBank()
+    : file (getDefaultFile())
+{
+}
+
+std::shared_ptr<const PresetBank> SharedPresetBank::getBank()
+{
+    const juce::ScopedLock sl (lock);
+
+    if (bank == nullptr)
+        bank = openBank();
+
+    return bank;
+}
+
+std::shared_ptr<const PresetBank> SharedPresetBank::openBank() const
+{
+    // A bank that exists but can't be read is left alone rather than replaced,
+    // as it may hold the user's presets.
+    if (file.existsAsFile())
+        return std::make_shared<const PresetBank> (file);
+
+    juce::MemoryBlock factoryBank;
+    PresetBank::write (PresetBank::getFactoryPresets(), factoryBank);
+    return std::make_shared<const PresetBank> (std::move (factoryBank));
+}
+
+void SharedPresetBank::setBank (std::shared_ptr<const PresetBank> newBank)
+{
+    const juce::ScopedLock sl (lock);
+    bank = std::move (newBank);
+}
+
+int SharedPresetBank::saveUserPreset (const juce::String& name, const juce::MemoryBlock& state)
+{
+    JUCE_ASSERT_MESSAGE_THREAD
+
+    auto current = getBank();
+    auto index = current->indexOf (name);
+
+    if (index >= 0 && current->isFactoryPreset (index))
+        return -1;
+
+    auto presets = current->getAllPresets();
+
+    if (index >= 0)
+    {
+        presets[(size_t) index].state = state;
+    }
+    else
+    {
+        index = (int) presets.size();
+        presets.push_back ({ name, state, false });
+    }
+
+    juce::MemoryBlock bankData;
+
+    if (! PresetBank::write (presets, bankData) || ! file.getParentDirectory().createDirectory())
+        return -1;
+
+    // Written to a temporary file and moved into place, so that a bank that's
+    // mapped elsewhere never sees a half-written file. Every instance keeps
+    // the old bank until the new one is swapped in.
+    juce::TemporaryFile temp (file);
+
+    if (! temp.getFile().replaceWithData (bankData.getData(), bankData.getSize()))
+        return -1;
+
+    if (! temp.getFile().replaceFileIn (file))
+    {
+        // Some systems won't replace a file that's mapped. Moving everyone onto
+        // a copy of the new bank in memory lets go of the old mapping, so the
+        // move can be tried again; if it still fails, the old file is reopened.
+        setBank (std::make_shared<const PresetBank> (std::move (bankData)));
+        current.reset();
+
+        if (! temp.overwriteTargetFileWithTemporary())
+        {
+            setBank (openBank());
+            return -1;
+        }
+    }
+
+    setBank (std::make_shared<const PresetBank> (file));
+    return index;
+}
+
+juce::File SharedPresetBank::getDefaultFile()
+{
+    return juce::File::getSpecialLocation (juce::File::userApplicationDataDirectory)
+               .getChildFile ("SimpleEQ")
+               .getChildFile ("Presets.seqbank");
+}
@@ -0,0 +1,156 @@
+/*
+  ==============================================================================
+
+    PresetBank.h
+    Factory and user presets in one memory-mapped file.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/*
+    Every preset lives in a single binary file that is memory-mapped rather
+    than read, so opening a bank of thousands of presets costs no more than
+    opening one: only the header is looked at, and the pages holding a preset
+    are only read in when that preset is used.
+
+    Layout, all little-endian:
+
+        offset  size
+        0       4       magic, "SEQB"
+        4       2       format version
+        6       2       size of one record in bytes
+        8       4       number of presets
+        12      4       number of name slots, a power of two
+        16      4       offset of the records
+        20      4       offset of the name slots
+        24      4       size of the whole file
+        28      4       reserved, zero
+
+    The records are indexed by preset number. Each holds the offset and length
+    of the preset's UTF-8 name, flags (bit 0 set for a factory preset), and the
+    offset and size of its state, which is a block in the format written by
+    writeParameterState(). States are 4-byte aligned.
+
+    The name slots are an open-addressed hash table: slot (FNV-1a of the name
+    & (numSlots - 1)) holds the preset number + 1, or 0 if empty, and
+    collisions move on to the next slot. There are always at least twice as
+    many slots as presets, so a lookup by name touches one or two.
+*/
+class PresetBank
+{
+public:
+    //==============================================================================
+    struct Preset
+    {
+        juce::String name;
+        juce::MemoryBlock state;
+        bool isFactory = false;
+    };
+
+    /** A preset's saved parameter state, pointing into the mapped file. */
+    struct StateData
+    {
+        const void* data = nullptr;
+        int size = 0;
+    };
+
+    //==============================================================================
+    /** An empty bank. */
+    PresetBank() = default;
+
+    /** Maps the file. If it's missing or isn't a bank, the result is empty. */
+    explicit PresetBank (const juce::File& file);
+
+    /** Reads a bank held in memory, as write() creates it. */
+    explicit PresetBank (juce::MemoryBlock bankData);
+
+    //==============================================================================
+    int getNumPresets() const noexcept          { return numPresets; }
+
+    juce::String getName (int index) const;
+    bool isFactoryPreset (int index) const noexcept;
+    StateData getState (int index) const noexcept;
+
+    /** The number of the preset with this exact name, or -1. */
+    int indexOf (const juce::String& name) const noexcept;
+
+    /** Copies every preset out of the file, for rewriting it. */
+    std::vector<Preset> getAllPresets() const;
+
+    //==============================================================================
+    /** Replaces the block's contents with a bank holding the presets. Returns
+        false if they don't fit in one. Names should be unique; only the first
+        of any duplicates can be found by name.
+    */
+    static bool write (const std::vector<Preset>& presets, juce::MemoryBlock& destData);
+
+    /** The presets that come with SimpleEQ. They only set the filters, so
+        loading one leaves the processing mode and oversampling alone.
+    */
+    static std::vector<Preset> getFactoryPresets();
+
+private:
+    //==============================================================================
+    struct Record
+    {
+        juce::uint32 nameOffset = 0, nameLength = 0, flags = 0, stateOffset = 0, stateSize = 0;
+    };
+
+    void open (const char* header, size_t size);
+    bool readRecord (int index, Record& record) const noexcept;
+
+    std::unique_ptr<juce::MemoryMappedFile> mappedFile;
+    juce::MemoryBlock ownedData;
+    const char* data = nullptr;
+    size_t dataSize = 0;
+    int numPresets = 0, recordSize = 0;
+    juce::uint32 numSlots = 0, recordsOffset = 0, slotsOffset = 0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (PresetBank)
+};
+
+//==============================================================================
+/**
+    The bank in the user's application data folder, shared by every SimpleEQ
+    instance in the process. Hold it through a juce::SharedResourcePointer.
+
+    Nothing is written until a user preset is saved. Until then, if there's no
+    file, the factory presets are served from memory, so creating a processor
+    in a command-line tool never touches the user's folder. User presets are
+    added after the factory ones, so a preset's number never changes once it
+    has one.
+*/
+class SharedPresetBank
+{
+public:
+    SharedPresetBank();
+
+    /** The bank as it is now. Saving a preset replaces it rather than changing
+        it, so what's returned stays valid. The first call opens the file, or
+        builds the factory bank if there isn't one. Safe to call from any thread.
+    */
+    std::shared_ptr<const PresetBank> getBank();
+
+    /** Adds a user preset, or replaces the user preset with the same name, and
+        returns its number. Returns -1 if the name belongs to a factory preset
+        or the file couldn't be written. Call from the message thread.
+    */
+    int saveUserPreset (const juce::String& name, const juce::MemoryBlock& state);
+
+    static juce::File getDefaultFile();
+
+private:
+    std::shared_ptr<const PresetBank> openBank() const;
+    void setBank (std::shared_ptr<const PresetBank> newBank);
+
+    juce::File file;
+    juce::CriticalSection lock;
+    std::shared_ptr<const PresetBank> bank;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SharedPresetBank)
+};
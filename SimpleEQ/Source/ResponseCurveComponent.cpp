@@ -0,0 +1,177 @@
+/*
+  ==============================================================================
+
+    ResponseCurveComponent.cpp
+
+  ==============================================================================
+*/
+
+#include "ResponseCurveComponent.h"
+#include "SpectrumAnalyzer.h"
+
+//==============================================================================
+// The parameters that change the shape of the curve.
+static const char* const responseParameterIDs[] = { "LowCut Freq", "LowCut Slope", "HighCut Freq", "HighCut Slope",
+                                                    "Peak Freq", "Peak Gain", "Peak Quality", "Oversampling" };
+
+ResponseCurveComponent::ResponseCurveComponent (juce::AudioProcessor& p, juce::AudioProcessorValueTreeState& s)
+    : processor (p), state (s)
+{
+    setInterceptsMouseClicks (false, false);
+
+    for (auto* paramID : responseParameterIDs)
+        state.addParameterListener (paramID, this);
+}
+
+ResponseCurveComponent::~ResponseCurveComponent()
+{
+    for (auto* paramID : responseParameterIDs)
+        state.removeParameterListener (paramID, this);
+
+    cancelPendingUpdate();
+}
+
+//==============================================================================
+void ResponseCurveComponent::paint (juce::Graphics& g)
+{
+    g.setColour (juce::Colours::white);
+    g.strokePath (curve, juce::PathStrokeType (2.0f));
+}
+
+void ResponseCurveComponent::resized()
+{
+    auto numColumns = (size_t) juce::jmax (1, getWidth());
+
+    for (auto* column : { &cosOmega, &cos2Omega, &numerator, &denominator, &scratch })
+        column->resize (numColumns);
+
+    for (auto* column : { &bandDecibels[0], &bandDecibels[1], &bandDecibels[2], &decibels })
+        column->resize (numColumns);
+
+    columnSampleRate = 0.0;
+
+    handleAsyncUpdate();
+    repaint();
+}
+
+//==============================================================================
+void ResponseCurveComponent::parameterChanged (const juce::String&, float)
+{
+    // This can arrive on any thread, and a burst of changes only needs one update.
+    triggerAsyncUpdate();
+}
+
+void ResponseCurveComponent::handleAsyncUpdate()
+{
+    if (getWidth() <= 0)
+        return;
+
+    auto& snapshot = parameters.update();
+    auto settings = snapshot.getFilterSettings();
+    auto sampleRate = (processor.getSampleRate() > 0.0 ? processor.getSampleRate() : 48000.0) * settings.oversamplingFactor;
+    auto changed = snapshot.changed;
+
+    if (! juce::approximatelyEqual (sampleRate, columnSampleRate))
+    {
+        updateColumnCosines (sampleRate);
+        changed = ParameterSnapshot::allParameters;
+    }
+
+    // Only the bands whose parameters have moved are evaluated again. The
+    // linear-phase LowCut has the same magnitude as the minimum-phase one.
+    if ((changed & ParameterSnapshot::lowCutBand) != 0)
+    {
+        auto lowCut = isLowCutBypassed (settings) ? CutFilterCoefficients()
+                                                  : makeLowCutCoefficients (settings.lowCutFreq, sampleRate, settings.lowCutSlope);
+        evaluateBand (lowCut.stages.data(), lowCut.numStages, bandDecibels[lowCutCurve]);
+    }
+
+    if ((changed & ParameterSnapshot::peakBand) != 0)
+    {
+        auto peak = makePeakCoefficients (settings.peakFreq, settings.peakGainInDecibels, settings.peakQuality, sampleRate);
+        evaluateBand (&peak, 1, bandDecibels[peakCurve]);
+    }
+
+    if ((changed & ParameterSnapshot::highCutBand) != 0)
+    {
+        auto highCut = isHighCutBypassed (settings) ? CutFilterCoefficients()
+                                                    : makeHighCutCoefficients (settings.highCutFreq, sampleRate, settings.highCutSlope);
+        evaluateBand (highCut.stages.data(), highCut.numStages, bandDecibels[highCutCurve]);
+    }
+
+    if ((changed & (ParameterSnapshot::lowCutBand | ParameterSnapshot::peakBand | ParameterSnapshot::highCutBand)) == 0)
+        return;
+
+    auto numColumns = (int) decibels.size();
+    juce::FloatVectorOperations::add (decibels.data(), bandDecibels[lowCutCurve].data(), bandDecibels[peakCurve].data(), numColumns);
+    juce::FloatVectorOperations::add (decibels.data(), bandDecibels[highCutCurve].data(), numColumns);
+
+    auto oldArea = curve.getBounds();
+    updatePath();
+
+    repaint (oldArea.getUnion (curve.getBounds()).getSmallestIntegerContainer().expanded (2));
+}
+
+void ResponseCurveComponent::updateColumnCosines (double sampleRate)
+{
+    columnSampleRate = sampleRate;
+
+    auto numColumns = (int) cosOmega.size();
+
+    for (int x = 0; x < numColumns; ++x)
+    {
+        auto frequency = SpectrumData::minFrequency
+                       * std::pow ((double) SpectrumData::maxFrequency / SpectrumData::minFrequency, (double) x / juce::jmax (1, numColumns - 1));
+        auto omega = juce::MathConstants<double>::twoPi * juce::jmin (frequency, 0.5 * sampleRate) / sampleRate;
+
+        cosOmega[(size_t) x]  = std::cos (omega);
+        cos2Omega[(size_t) x] = std::cos (2.0 * omega);
+    }
+}
+
+void ResponseCurveComponent::evaluateBand (const BiquadCoefficients* sections, int numSections, std::vector<float>& result)
+{
+    auto numColumns = (int) cosOmega.size();
+
+    juce::FloatVectorOperations::fill (numerator.data(),   1.0, numColumns);
+    juce::FloatVectorOperations::fill (denominator.data(), 1.0, numColumns);
+
+    // For each section, |H|^2 = (n0 + n1 cos w + n2 cos 2w) / (d0 + d1 cos w + d2 cos 2w).
+    auto accumulate = [&] (std::vector<double>& product, double c0, double c1, double c2)
+    {
+        juce::FloatVectorOperations::copy (scratch.data(), cos2Omega.data(), numColumns);
+        juce::FloatVectorOperations::multiply (scratch.data(), c2, numColumns);
+        juce::FloatVectorOperations::addWithMultiply (scratch.data(), cosOmega.data(), c1, numColumns);
+        juce::FloatVectorOperations::add (scratch.data(), c0, numColumns);
+        juce::FloatVectorOperations::multiply (product.data(), scratch.data(), numColumns);
+    };
+
+    for (int i = 0; i < numSections; ++i)
+    {
+        auto& s = sections[i];
+
+        accumulate (numerator,   s.b0 * s.b0 + s.b1 * s.b1 + s.b2 * s.b2, 2.0 * (s.b0 * s.b1 + s.b1 * s.b2), 2.0 * s.b0 * s.b2);
+        accumulate (denominator, 1.0 + s.a1 * s.a1 + s.a2 * s.a2,         2.0 * (s.a1 + s.a1 * s.a2),        2.0 * s.a2);
+    }
+
+    for (size_t x = 0; x < result.size(); ++x)
+        result[x] = (float) (10.0 * std::log10 (juce::jmax (numerator[x], 1.0e-20) / juce::jmax (denominator[x], 1.0e-20)));
+}
+
+void ResponseCurveComponent::updatePath()
+{
+    curve.clear();
+    curve.preallocateSpace (3 * (int) decibels.size());
+
+    auto bottom = (float) getHeight();
+
+    for (size_t x = 0; x < decibels.size(); ++x)
+    {
+        auto y = juce::jmap (juce::jlimit (-maxDecibels, maxDecibels, decibels[x]), -maxDecibels, maxDecibels, bottom, 0.0f);
+
+        if (x == 0)
+            curve.startNewSubPath (0.0f, y);
+        else
+            curve.lineTo ((float) x, y);
+    }
+}
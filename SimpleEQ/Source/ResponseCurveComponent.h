@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    ResponseCurveComponent.h
+    The magnitude response of the filter chain, drawn over the analyzer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ParameterSnapshot.h"
+
+//==============================================================================
+/**
+    Draws the magnitude response of the LowCut, Peak and HighCut chain on the
+    same log frequency axis as the spectrum analyzer.
+
+    Nothing is computed in paint(), which only strokes a cached path. When one
+    of the filter parameters changes, the band it belongs to is redesigned on
+    the message thread and its response evaluated for every pixel column at
+    once: each section's numerator and denominator are accumulated across the
+    columns with juce::FloatVectorOperations, against cosines that are only
+    worked out again when the width or sample rate changes. Each band's
+    response is kept, so the bands that didn't change are just added back in.
+    Only the area covered by the old and new curves is repainted.
+*/
+class ResponseCurveComponent  : public juce::Component,
+                                private juce::AudioProcessorValueTreeState::Listener,
+                                private juce::AsyncUpdater
+{
+public:
+    ResponseCurveComponent (juce::AudioProcessor& processor, juce::AudioProcessorValueTreeState& state);
+    ~ResponseCurveComponent() override;
+
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+
+private:
+    void parameterChanged (const juce::String& parameterID, float newValue) override;
+    void handleAsyncUpdate() override;
+
+    void updateColumnCosines (double sampleRate);
+    void evaluateBand (const BiquadCoefficients* sections, int numSections, std::vector<float>& result);
+    void updatePath();
+
+    // The range of the curve's vertical axis.
+    static constexpr float maxDecibels = 24.0f;
+
+    juce::AudioProcessor& processor;
+    juce::AudioProcessorValueTreeState& state;
+    ParameterSnapshotReader parameters { state };
+
+    // One entry per pixel column. The LowCut, Peak and HighCut responses are
+    // kept apart, and decibels is their sum.
+    enum { lowCutCurve, peakCurve, highCutCurve, numBands };
+
+    std::vector<double> cosOmega, cos2Omega, numerator, denominator, scratch;
+    std::array<std::vector<float>, numBands> bandDecibels;
+    std::vector<float> decibels;
+    double columnSampleRate = 0.0;
+
+    juce::Path curve;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (ResponseCurveComponent)
+};
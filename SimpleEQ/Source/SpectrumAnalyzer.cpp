@@ -0,0 +1,232 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.cpp
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+#include "PluginProcessor.h"
+
+//==============================================================================
+SpectrumAnalyzer::SpectrumAnalyzer (SimpleEQAudioProcessor& p)
+    : processor (p),
+      pre (p.getPreFilterFifo()),
+      post (p.getPostFilterFifo())
+{
+    for (auto& value : spectrum.getWriteBuffer().pre)    value = SpectrumData::minDecibels;
+    for (auto& value : spectrum.getWriteBuffer().post)   value = SpectrumData::minDecibels;
+
+    pre.fifo.setActive (true);
+    post.fifo.setActive (true);
+
+    analyzerThread->addTimeSliceClient (this);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+    pre.fifo.setActive (false);
+    post.fifo.setActive (false);
+
+    // Blocks until the analyzer thread has finished with us.
+    analyzerThread->removeTimeSliceClient (this);
+}
+
+const SpectrumData* SpectrumAnalyzer::pullNewSpectrum() noexcept
+{
+    return spectrum.pull() ? &spectrum.getReadBuffer() : nullptr;
+}
+
+//==============================================================================
+int SpectrumAnalyzer::useTimeSlice()
+{
+    auto sampleRate = processor.getSampleRate();
+
+    if (sampleRate <= 0.0)
+        return sliceIntervalMs;
+
+    if (! juce::approximatelyEqual (sampleRate, currentSampleRate))
+        updatePointMapping (sampleRate);
+
+    auto analyzedAny = false;
+
+    for (auto* tap : { &pre, &post })
+        for (int frame = 0; frame < maxFramesPerSlice && analyzeNextFrame (*tap); ++frame)
+            analyzedAny = true;
+
+    if (analyzedAny)
+    {
+        auto& data = spectrum.getWriteBuffer();
+        reducePoints (pre, data.pre);
+        reducePoints (post, data.post);
+        spectrum.publish();
+    }
+
+    return sliceIntervalMs;
+}
+
+bool SpectrumAnalyzer::analyzeNextFrame (Tap& tap)
+{
+    tap.numIncoming += tap.fifo.pull (tap.incoming.data() + tap.numIncoming, hopSize - tap.numIncoming);
+
+    if (tap.numIncoming < hopSize)
+        return false;
+
+    tap.numIncoming = 0;
+
+    std::move (tap.history.begin() + hopSize, tap.history.end(), tap.history.begin());
+    std::copy (tap.incoming.begin(), tap.incoming.end(), tap.history.end() - hopSize);
+
+    std::copy (tap.history.begin(), tap.history.end(), fftData.begin());
+    window.multiplyWithWindowingTable (fftData.data(), (size_t) fftSize);
+    fft.performFrequencyOnlyForwardTransform (fftData.data());
+
+    // A full-scale sine comes out of a Hann-windowed FFT with a magnitude of
+    // fftSize / 4, so this makes it read 0 dB.
+    constexpr auto scale = 16.0f / ((float) fftSize * (float) fftSize);
+
+    for (size_t bin = 0; bin < tap.averagePower.size(); ++bin)
+    {
+        auto power = fftData[bin] * fftData[bin] * scale;
+        tap.averagePower[bin] = power + decay * (tap.averagePower[bin] - power);
+    }
+
+    return true;
+}
+
+void SpectrumAnalyzer::updatePointMapping (double sampleRate)
+{
+    currentSampleRate = sampleRate;
+    decay = (float) std::exp (-hopSize / (sampleRate * averagingSeconds));
+
+    auto maxBin = fftSize / 2;
+
+    for (int i = 0; i < SpectrumData::numPoints; ++i)
+    {
+        // Each point covers the bins between it and the next one, and at
+        // least the bin nearest to it.
+        auto low  = SpectrumData::getFrequencyForPoint (i) * fftSize / sampleRate;
+        auto high = SpectrumData::getFrequencyForPoint (i + 1) * fftSize / sampleRate;
+
+        auto first = juce::jlimit (0, maxBin, juce::roundToInt (low));
+        auto last  = juce::jlimit (first, maxBin, (int) std::floor (high));
+
+        pointBins[(size_t) i] = { first, last };
+    }
+
+    for (auto* tap : { &pre, &post })
+    {
+        tap->averagePower.fill (0.0f);
+        tap->numIncoming = 0;
+    }
+}
+
+void SpectrumAnalyzer::reducePoints (const Tap& tap, std::array<float, SpectrumData::numPoints>& points) const noexcept
+{
+    for (size_t i = 0; i < points.size(); ++i)
+    {
+        auto [first, last] = pointBins[i];
+        auto peak = *std::max_element (tap.averagePower.begin() + first, tap.averagePower.begin() + last + 1);
+
+        points[i] = juce::jmax (SpectrumData::minDecibels, 10.0f * std::log10 (peak + 1.0e-20f));
+    }
+}
+
+//==============================================================================
+SpectrumAnalyzerComponent::SpectrumAnalyzerComponent (SimpleEQAudioProcessor& processor)
+    : analyzer (processor)
+{
+    setOpaque (true);
+    startTimerHz (displayRateHz);
+}
+
+void SpectrumAnalyzerComponent::paint (juce::Graphics& g)
+{
+    g.drawImageAt (grid, 0, 0);
+
+    g.setColour (juce::Colours::lightblue.withAlpha (0.5f));
+    g.strokePath (prePath, juce::PathStrokeType (1.0f));
+
+    g.setColour (juce::Colours::orange);
+    g.strokePath (postPath, juce::PathStrokeType (1.5f));
+}
+
+void SpectrumAnalyzerComponent::resized()
+{
+    drawGrid();
+
+    prePath.clear();
+    postPath.clear();
+}
+
+float SpectrumAnalyzerComponent::getXForFrequency (float frequency) const noexcept
+{
+    auto proportion = std::log (frequency / SpectrumData::minFrequency)
+                    / std::log (SpectrumData::maxFrequency / SpectrumData::minFrequency);
+
+    return proportion * (float) getWidth();
+}
+
+float SpectrumAnalyzerComponent::getYForDecibels (float decibels) const noexcept
+{
+    return juce::jmap (decibels, SpectrumData::minDecibels, SpectrumData::maxDecibels, (float) getHeight(), 0.0f);
+}
+
+void SpectrumAnalyzerComponent::timerCallback()
+{
+    if (auto* data = analyzer.pullNewSpectrum())
+    {
+        updatePath (prePath, data->pre);
+        updatePath (postPath, data->post);
+        repaint();
+    }
+}
+
+void SpectrumAnalyzerComponent::updatePath (juce::Path& path, const std::array<float, SpectrumData::numPoints>& points) const
+{
+    path.clear();
+    path.preallocateSpace (3 * SpectrumData::numPoints);
+
+    for (int i = 0; i < SpectrumData::numPoints; ++i)
+    {
+        juce::Point<float> point { getXForFrequency (SpectrumData::getFrequencyForPoint (i)), getYForDecibels (points[(size_t) i]) };
+
+        if (i == 0)
+            path.startNewSubPath (point);
+        else
+            path.lineTo (point);
+    }
+}
+
+void SpectrumAnalyzerComponent::drawGrid()
+{
+    grid = juce::Image (juce::Image::RGB, juce::jmax (1, getWidth()), juce::jmax (1, getHeight()), true);
+    juce::Graphics g (grid);
+
+    g.fillAll (juce::Colours::black);
+    g.setFont (10.0f);
+
+    for (auto frequency : { 20.0f, 50.0f, 100.0f, 200.0f, 500.0f, 1000.0f, 2000.0f, 5000.0f, 10000.0f, 20000.0f })
+    {
+        auto x = getXForFrequency (frequency);
+
+        g.setColour (juce::Colours::dimgrey);
+        g.drawVerticalLine (juce::roundToInt (x), 0.0f, (float) getHeight());
+
+        g.setColour (juce::Colours::lightgrey);
+        g.drawText (frequency >= 1000.0f ? juce::String (frequency / 1000.0f) + "k" : juce::String (frequency),
+                    juce::roundToInt (x) + 2, getHeight() - 14, 40, 12, juce::Justification::left);
+    }
+
+    for (auto decibels = -84.0f; decibels <= SpectrumData::maxDecibels; decibels += 12.0f)
+    {
+        auto y = getYForDecibels (decibels);
+
+        g.setColour (juce::Colours::dimgrey);
+        g.drawHorizontalLine (juce::roundToInt (y), 0.0f, (float) getWidth());
+
+        g.setColour (juce::Colours::lightgrey);
+        g.drawText (juce::String (juce::roundToInt (decibels)) + " dB", 2, juce::roundToInt (y) + 1, 50, 12, juce::Justification::left);
+    }
+}
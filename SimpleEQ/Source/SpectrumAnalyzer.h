@@ -0,0 +1,150 @@
+/*
+  ==============================================================================
+
+    SpectrumAnalyzer.h
+    A pre/post spectrum analyzer, computed off the audio and message threads.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AnalyzerFifo.h"
+#include "TripleBuffer.h"
+
+class SimpleEQAudioProcessor;
+
+//==============================================================================
+/** Both spectra, reduced to a fixed number of log-spaced points in decibels. */
+struct SpectrumData
+{
+    static constexpr int numPoints = 256;
+    static constexpr float minFrequency = 20.0f, maxFrequency = 20000.0f;
+    static constexpr float minDecibels = -96.0f, maxDecibels = 12.0f;
+
+    std::array<float, numPoints> pre, post;
+
+    /** The frequency that point i of the spectra shows. */
+    static float getFrequencyForPoint (int i) noexcept
+    {
+        return minFrequency * std::pow (maxFrequency / minFrequency, (float) i / (float) (numPoints - 1));
+    }
+};
+
+//==============================================================================
+/**
+    Turns the audio going into and out of the filters into smoothed spectra.
+
+    While one of these exists the processor copies every block into its
+    analyzer FIFOs. A background thread, shared by every analyzer in the
+    process, drains them, runs Hann-windowed FFTs with 75% overlap, averages
+    the power in each bin over about a quarter of a second and reduces the
+    result to SpectrumData::numPoints points, which are handed to the editor
+    through a TripleBuffer. The amount of work per analyzer is capped per time
+    slice, so an analyzer that falls behind skips audio rather than taking
+    more CPU.
+*/
+class SpectrumAnalyzer  : private juce::TimeSliceClient
+{
+public:
+    //==============================================================================
+    static constexpr int fftOrder = 11;
+    static constexpr int fftSize = 1 << fftOrder;
+    static constexpr int hopSize = fftSize / 4;
+
+    explicit SpectrumAnalyzer (SimpleEQAudioProcessor& processor);
+    ~SpectrumAnalyzer() override;
+
+    /** Returns the newest spectra if they've changed since the last call, or
+        nullptr. The pointer stays valid until the next call. Call from one
+        thread only, normally the message thread.
+    */
+    const SpectrumData* pullNewSpectrum() noexcept;
+
+private:
+    //==============================================================================
+    struct AnalyzerThread  : public juce::TimeSliceThread
+    {
+        AnalyzerThread()  : juce::TimeSliceThread ("SimpleEQ Spectrum Analyzer")   { startThread (juce::Thread::Priority::low); }
+        ~AnalyzerThread() override                                                { stopThread (1000); }
+    };
+
+    /** One signal being analyzed: its FIFO and its running average. */
+    struct Tap
+    {
+        explicit Tap (AnalyzerFifo& f)  : fifo (f) {}
+
+        AnalyzerFifo& fifo;
+        std::array<float, fftSize> history {};
+        std::array<float, hopSize> incoming {};
+        std::array<float, fftSize / 2 + 1> averagePower {};
+        int numIncoming = 0;
+    };
+
+    int useTimeSlice() override;
+    bool analyzeNextFrame (Tap& tap);
+    void updatePointMapping (double sampleRate);
+    void reducePoints (const Tap& tap, std::array<float, SpectrumData::numPoints>& points) const noexcept;
+
+    //==============================================================================
+    // The most frames each tap analyzes per time slice, and the time between slices.
+    static constexpr int maxFramesPerSlice = 8;
+    static constexpr int sliceIntervalMs = 15;
+    static constexpr double averagingSeconds = 0.25;
+
+    SimpleEQAudioProcessor& processor;
+    Tap pre, post;
+
+    juce::dsp::FFT fft { fftOrder };
+    juce::dsp::WindowingFunction<float> window { (size_t) fftSize, juce::dsp::WindowingFunction<float>::hann, false };
+    std::array<float, 2 * fftSize> fftData {};
+
+    double currentSampleRate = 0.0;
+    float decay = 0.0f;
+
+    // The range of FFT bins that each display point covers.
+    std::array<std::pair<int, int>, SpectrumData::numPoints> pointBins {};
+
+    TripleBuffer<SpectrumData> spectrum;
+
+    juce::SharedResourcePointer<AnalyzerThread> analyzerThread;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyzer)
+};
+
+//==============================================================================
+/**
+    Draws the pre and post spectra. The paths are rebuilt only when the
+    analyzer has something new, at most at displayRateHz, and painting just
+    strokes the cached paths over a cached grid.
+*/
+class SpectrumAnalyzerComponent  : public juce::Component,
+                                   private juce::Timer
+{
+public:
+    explicit SpectrumAnalyzerComponent (SimpleEQAudioProcessor& processor);
+
+    void paint (juce::Graphics& g) override;
+    void resized() override;
+
+    /** The x position of a frequency, for anything drawn on top of the spectra. */
+    float getXForFrequency (float frequency) const noexcept;
+
+    /** The y position of a level in decibels. */
+    float getYForDecibels (float decibels) const noexcept;
+
+private:
+    void timerCallback() override;
+    void updatePath (juce::Path& path, const std::array<float, SpectrumData::numPoints>& points) const;
+    void drawGrid();
+
+    static constexpr int displayRateHz = 30;
+
+    SpectrumAnalyzer analyzer;
+    juce::Path prePath, postPath;
+    juce::Image grid;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SpectrumAnalyzerComponent)
+};
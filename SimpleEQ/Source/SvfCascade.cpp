@@ -0,0 +1,375 @@
+/*
+  ==============================================================================
+
+    SvfCascade.cpp
+
+  ==============================================================================
+*/
+
+#include "SvfCascade.h"
+
+//==============================================================================
+template <typename SampleType>
+void SvfCascade<SampleType>::prepare (int maximumNumChannels, int glideLengthInSamples)
+{
+    jassert (maximumNumChannels > 0 && glideLengthInSamples >= 0);
+
+    maxNumChannels = maximumNumChannels;
+    numGroups = (maxNumChannels + channelsPerGroup - 1) / channelsPerGroup;
+    glideLength = glideLengthInSamples;
+
+    // One block of memory for the state, the interleaved chunk and the
+    // per-sample coefficients, plus room to align the start of it.
+    auto stateBytes = (size_t) numGroups * (size_t) numStages * 2 * sizeof (SIMDType);
+    auto chunkBytes = (size_t) numGroups * (size_t) chunkSize * sizeof (SIMDType);
+    auto coefficientBytes = (size_t) numStages * 3 * (size_t) chunkSize * sizeof (SampleType);
+
+    memory.allocate (stateBytes + chunkBytes + coefficientBytes + SIMDType::SIMDRegisterSize, true);
+
+    auto* aligned = reinterpret_cast<char*> (SIMDType::getNextSIMDAlignedPtr (reinterpret_cast<SampleType*> (memory.get())));
+    state        = reinterpret_cast<SIMDType*> (aligned);
+    interleaved  = reinterpret_cast<SIMDType*> (aligned + stateBytes);
+    coefficients = reinterpret_cast<SampleType*> (aligned + stateBytes + chunkBytes);
+    lastNumChannels = 0;
+
+    reset();
+}
+
+template <typename SampleType>
+void SvfCascade<SampleType>::setGlideLength (int glideLengthInSamples) noexcept
+{
+    jassert (glideLengthInSamples >= 0);
+
+    for (int i = 0; i < numStages; ++i)
+        finishGlide (i);
+
+    glideLength = glideLengthInSamples;
+    updateActiveStages();
+}
+
+template <typename SampleType>
+void SvfCascade<SampleType>::reset() noexcept
+{
+    if (state != nullptr)
+        juce::zeromem (state, (size_t) numGroups * (size_t) numStages * 2 * sizeof (SIMDType));
+
+    for (int i = 0; i < numStages; ++i)
+        finishGlide (i);
+
+    hasSettings = false;
+    updateActiveStages();
+}
+
+template <typename SampleType>
+void SvfCascade<SampleType>::setSettings (const FilterSettings& settings, double sampleRate) noexcept
+{
+    jassert (sampleRate > 0.0);
+
+    // Prewarped, and kept safely below Nyquist as the biquad designs are.
+    auto cutoff = [sampleRate] (double frequency)
+    {
+        return (SampleType) (juce::MathConstants<double>::pi * juce::jlimit (1.0, sampleRate * 0.49, frequency) / sampleRate);
+    };
+
+    // The same Butterworth sections as the biquads: a high-pass is the input
+    // minus the band- and low-pass outputs, a low-pass is the low-pass output.
+    auto numLowCut  = (settings.linearPhaseLowCut || isLowCutBypassed (settings)) ? 0 : (int) settings.lowCutSlope + 1;
+    auto numHighCut = isHighCutBypassed (settings) ? 0 : (int) settings.highCutSlope + 1;
+
+    for (int i = 0; i < numLowCutStages; ++i)
+    {
+        if (i < numLowCut)
+        {
+            auto k = (SampleType) (1.0 / getButterworthStageQ (numLowCut, i));
+            setTarget (i, cutoff (settings.lowCutFreq), k, 1, -k, -1);
+        }
+        else
+        {
+            setTarget (i, stages[(size_t) i].value[Stage::cutoff], stages[(size_t) i].value[Stage::damping], 1, 0, 0);
+        }
+    }
+
+    // A bell adds the band-pass output scaled by k (A^2 - 1), with the damping
+    // narrowed by A so that the boost and cut are symmetrical, as in the RBJ
+    // peaking design. At 0 dB that's the input alone.
+    auto A = FastMath::pow10 ((double) settings.peakGainInDecibels / 40.0);
+    auto peakDamping = 1.0 / (juce::jmax (0.001, (double) settings.peakQuality) * A);
+    setTarget (numLowCutStages, cutoff (settings.peakFreq), (SampleType) peakDamping,
+               1, (SampleType) (peakDamping * (A * A - 1.0)), 0);
+
+    for (int i = 0; i < numLowCutStages; ++i)
+    {
+        auto index = numLowCutStages + 1 + i;
+
+        if (i < numHighCut)
+            setTarget (index, cutoff (settings.highCutFreq), (SampleType) (1.0 / getButterworthStageQ (numHighCut, i)), 0, 0, 1);
+        else
+            setTarget (index, stages[(size_t) index].value[Stage::cutoff], stages[(size_t) index].value[Stage::damping], 1, 0, 0);
+    }
+
+    hasSettings = true;
+    updateActiveStages();
+}
+
+template <typename SampleType>
+void SvfCascade<SampleType>::setTarget (int index, SampleType cutoff, SampleType damping,
+                                        SampleType mix0, SampleType mix1, SampleType mix2) noexcept
+{
+    auto& stage = stages[(size_t) index];
+    stage.target = { cutoff, damping, mix0, mix1, mix2 };
+
+    if (! stage.active)
+    {
+        // A slot with nothing to do stays off.
+        if (isPassThrough (stage.target))
+        {
+            stage.value = stage.target;
+            stage.glideRemaining = 0;
+            return;
+        }
+
+        // A slot that's switched on starts from silence, already at its
+        // cutoff, and fades in from passing its input straight through.
+        for (int g = 0; g < numGroups; ++g)
+        {
+            state[(g * numStages + index) * 2]     = SIMDType::expand (0);
+            state[(g * numStages + index) * 2 + 1] = SIMDType::expand (0);
+        }
+
+        stage.value = { cutoff, damping, 1, 0, 0 };
+        stage.active = true;
+    }
+
+    if (! hasSettings || glideLength <= 1)
+    {
+        finishGlide (index);
+        stage.glideRemaining = 0;
+        stage.value = stage.target;
+        stage.active = ! isPassThrough (stage.value);
+        return;
+    }
+
+    // A glide already under way carries on from wherever it has got to.
+    auto scale = (SampleType) 1 / (SampleType) glideLength;
+
+    for (int v = 0; v < Stage::numValues; ++v)
+        stage.step[(size_t) v] = (stage.target[(size_t) v] - stage.value[(size_t) v]) * scale;
+
+    stage.glideRemaining = glideLength;
+}
+
+template <typename SampleType>
+void SvfCascade<SampleType>::finishGlide (int index) noexcept
+{
+    auto& stage = stages[(size_t) index];
+
+    if (stage.glideRemaining > 0)
+    {
+        stage.glideRemaining = 0;
+        stage.value = stage.target;
+    }
+
+    if (isPassThrough (stage.value))
+        stage.active = false;
+}
+
+template <typename SampleType>
+void SvfCascade<SampleType>::updateActiveStages() noexcept
+{
+    numActive = 0;
+
+    for (int i = 0; i < numStages; ++i)
+        if (stages[(size_t) i].active)
+            activeStages[numActive++] = i;
+}
+
+//==============================================================================
+template <typename SampleType>
+void SvfCascade<SampleType>::process (juce::AudioBuffer<SampleType>& buffer, int numChannels) noexcept
+{
+    process (juce::dsp::AudioBlock<SampleType> (buffer), numChannels);
+}
+
+template <typename SampleType>
+void SvfCascade<SampleType>::process (const juce::dsp::AudioBlock<SampleType>& block, int numChannels) noexcept
+{
+    jassert (interleaved != nullptr);
+    jassert (numChannels <= maxNumChannels);
+
+    numChannels = juce::jmin (numChannels, maxNumChannels, (int) block.getNumChannels());
+    auto blockLength = (int) block.getNumSamples();
+
+    // Nothing to filter: leave the buffer exactly as it is.
+    if (isNeutral() || numChannels <= 0)
+        return;
+
+    if (numChannels != lastNumChannels)
+    {
+        // Unused lanes must hold silence so they can never go denormal or NaN.
+        juce::zeromem (interleaved, (size_t) numGroups * (size_t) chunkSize * sizeof (SIMDType));
+        lastNumChannels = numChannels;
+    }
+
+    auto numActiveGroups = (numChannels + channelsPerGroup - 1) / channelsPerGroup;
+    auto* lanes = reinterpret_cast<SampleType*> (interleaved);
+
+    for (int start = 0, numSamples = 0; start < blockLength && ! isNeutral(); start += numSamples)
+    {
+        numSamples = juce::jmin (chunkSize, blockLength - start);
+
+        // A chunk ends where a glide does, so that a glide never overshoots.
+        for (int j = 0; j < numActive; ++j)
+        {
+            auto remaining = stages[(size_t) activeStages[j]].glideRemaining;
+
+            if (remaining > 0)
+                numSamples = juce::jmin (numSamples, remaining);
+        }
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* src = block.getChannelPointer ((size_t) ch) + start;
+            auto* dst = lanes + (ch / channelsPerGroup) * chunkSize * channelsPerGroup + ch % channelsPerGroup;
+
+            for (int i = 0; i < numSamples; ++i)
+                dst[i * channelsPerGroup] = src[i];
+        }
+
+        for (int j = 0; j < numActive; ++j)
+        {
+            auto* c = coefficients + activeStages[j] * 3 * chunkSize;
+            fillCoefficients (stages[(size_t) activeStages[j]], c, c + chunkSize, c + 2 * chunkSize, numSamples);
+        }
+
+        run (numActiveGroups, numSamples);
+
+        for (int ch = 0; ch < numChannels; ++ch)
+        {
+            auto* src = lanes + (ch / channelsPerGroup) * chunkSize * channelsPerGroup + ch % channelsPerGroup;
+            auto* dst = block.getChannelPointer ((size_t) ch) + start;
+
+            for (int i = 0; i < numSamples; ++i)
+                dst[i] = src[i * channelsPerGroup];
+        }
+
+        // Move every glide on past the chunk, and switch off slots that have
+        // finished fading out.
+        auto finished = false;
+
+        for (int j = 0; j < numActive; ++j)
+        {
+            auto& stage = stages[(size_t) activeStages[j]];
+
+            if (stage.glideRemaining == 0)
+                continue;
+
+            stage.glideRemaining -= numSamples;
+
+            if (stage.glideRemaining == 0)
+            {
+                // Land exactly on the target rather than wherever the rounding got to.
+                stage.value = stage.target;
+                stage.active = ! isPassThrough (stage.value);
+                finished = true;
+            }
+            else
+            {
+                for (int v = 0; v < Stage::numValues; ++v)
+                    stage.value[(size_t) v] += stage.step[(size_t) v] * (SampleType) numSamples;
+            }
+        }
+
+        if (finished)
+            updateActiveStages();
+    }
+}
+
+template <typename SampleType>
+void SvfCascade<SampleType>::fillCoefficients (const Stage& stage, SampleType* a1, SampleType* a2, SampleType* a3, int numSamples) noexcept
+{
+    // With g = p / q from FastMath::tan(), the section's gains
+    //     a1 = 1 / (1 + g (g + k)),   a2 = g a1,   a3 = g a2
+    // share a single division.
+    auto design = [] (SampleType cutoff, SampleType damping, SampleType& c1, SampleType& c2, SampleType& c3) noexcept
+    {
+        SampleType p, q;
+        FastMath::tan (cutoff, p, q);
+
+        auto scale = (SampleType) 1 / (q * q + p * (p + damping * q));
+        c1 = q * q * scale;
+        c2 = p * q * scale;
+        c3 = p * p * scale;
+    };
+
+    if (stage.glideRemaining == 0 || (stage.step[Stage::cutoff] == 0 && stage.step[Stage::damping] == 0))
+    {
+        SampleType c1, c2, c3;
+        design (stage.value[Stage::cutoff], stage.value[Stage::damping], c1, c2, c3);
+
+        std::fill (a1, a1 + numSamples, c1);
+        std::fill (a2, a2 + numSamples, c2);
+        std::fill (a3, a3 + numSamples, c3);
+        return;
+    }
+
+    // Each sample takes one more step along the glide. There are no branches
+    // in here and every array is contiguous, so the loop is vectorised.
+    auto cutoff = stage.value[Stage::cutoff], cutoffStep = stage.step[Stage::cutoff];
+    auto damping = stage.value[Stage::damping], dampingStep = stage.step[Stage::damping];
+
+    for (int i = 0; i < numSamples; ++i)
+    {
+        auto steps = (SampleType) (i + 1);
+        design (cutoff + cutoffStep * steps, damping + dampingStep * steps, a1[i], a2[i], a3[i]);
+    }
+}
+
+template <typename SampleType>
+void SvfCascade<SampleType>::run (int numActiveGroups, int numSamples) noexcept
+{
+    for (int j = 0; j < numActive; ++j)
+    {
+        auto index = activeStages[j];
+        auto& stage = stages[(size_t) index];
+
+        const auto* a1 = coefficients + index * 3 * chunkSize;
+        const auto* a2 = a1 + chunkSize;
+        const auto* a3 = a2 + chunkSize;
+
+        auto gliding = stage.glideRemaining > 0;
+        auto mix0 = stage.value[Stage::mix0], mix1 = stage.value[Stage::mix1], mix2 = stage.value[Stage::mix2];
+        auto step0 = gliding ? stage.step[Stage::mix0] : (SampleType) 0;
+        auto step1 = gliding ? stage.step[Stage::mix1] : (SampleType) 0;
+        auto step2 = gliding ? stage.step[Stage::mix2] : (SampleType) 0;
+
+        for (int g = 0; g < numActiveGroups; ++g)
+        {
+            auto* data = interleaved + g * chunkSize;
+            auto ic1 = state[(g * numStages + index) * 2];
+            auto ic2 = state[(g * numStages + index) * 2 + 1];
+
+            for (int i = 0; i < numSamples; ++i)
+            {
+                auto steps = (SampleType) (i + 1);
+                auto x = data[i];
+
+                auto v3 = x - ic2;
+                auto v1 = SIMDType::expand (a1[i]) * ic1 + SIMDType::expand (a2[i]) * v3;
+                auto v2 = ic2 + SIMDType::expand (a2[i]) * ic1 + SIMDType::expand (a3[i]) * v3;
+                ic1 = v1 + v1 - ic1;
+                ic2 = v2 + v2 - ic2;
+
+                data[i] = SIMDType::expand (mix0 + step0 * steps) * x
+                        + SIMDType::expand (mix1 + step1 * steps) * v1
+                        + SIMDType::expand (mix2 + step2 * steps) * v2;
+            }
+
+            state[(g * numStages + index) * 2]     = ic1;
+            state[(g * numStages + index) * 2 + 1] = ic2;
+        }
+    }
+}
+
+//==============================================================================
+template class SvfCascade<float>;
+template class SvfCascade<double>;
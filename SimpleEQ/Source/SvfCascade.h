@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    SvfCascade.h
+    The filter chain as topology-preserving state-variable filters, for
+    smooth modulation.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "FilterDesign.h"
+#include "../../Shared/FastMath.h"
+
+//==============================================================================
+/**
+    An alternative to BiquadCascade that runs each section as a trapezoidal
+    (topology-preserving transform) state-variable filter, after Zavalishin
+    and Simper.
+
+    A biquad's coefficients are a long way from its cutoff: moving the cutoff
+    means a sin, a cos and a division per section, and jumping the
+    coefficients of a direct form under a running signal can make it ring or
+    blow up. An SVF is set directly by g = tan (pi * fc / fs), its damping
+    k = 1 / Q and three output mix gains, and its state stays meaningful
+    however fast they move. So here every section glides to new settings in
+    a straight line, one step per sample, and the cutoff is prewarped for
+    each sample with FastMath::tan(), a rational approximation that costs a
+    few multiplies. The glides are worked out for a whole chunk at a time in
+    branch-free loops over contiguous arrays, which the compiler vectorises.
+
+    The settings map onto nine fixed slots: four LowCut sections, the Peak and
+    four HighCut sections. At steady state each has exactly the response of
+    the matching biquad. A slot that isn't needed glides its mix to pass its
+    input straight through, and once it gets there it's switched off, so
+    changing a slope, switching a band on or off or taking the Peak to 0 dB
+    fades rather than clicks, with no crossfade between two cascades. A
+    cascade with nothing switched on is neutral and process() leaves the
+    buffer alone.
+
+    As in BiquadCascade, the channels are interleaved into the lanes of a
+    juce::dsp::SIMDRegister, so that a group of channels is filtered for the
+    cost of one.
+*/
+template <typename SampleType>
+class SvfCascade
+{
+public:
+    using SIMDType = juce::dsp::SIMDRegister<SampleType>;
+
+    /** The number of channels that fit into one register on this platform. */
+    static constexpr int channelsPerGroup = (int) SIMDType::SIMDNumElements;
+
+    /** The number of samples interleaved and filtered at a time. */
+    static constexpr int chunkSize = 64;
+
+    /** LowCut, Peak and HighCut, in that order. */
+    static constexpr int numLowCutStages = CutFilterCoefficients::maxStages;
+    static constexpr int numStages = 2 * numLowCutStages + 1;
+
+    //==============================================================================
+    SvfCascade() = default;
+
+    /** Allocates the state and scratch space for up to the given number of
+        channels, and sets how many samples a glide to new settings takes.
+        Call before processing.
+    */
+    void prepare (int maximumNumChannels, int glideLengthInSamples);
+
+    /** Changes how long glides take, for when the rate the cascade runs at
+        changes. Any glide in progress is finished.
+    */
+    void setGlideLength (int glideLengthInSamples) noexcept;
+
+    /** Clears the filter state and finishes any glide. The next call to
+        setSettings() takes effect straight away.
+    */
+    void reset() noexcept;
+
+    /** Glides from where the filters are now to the given settings, starting
+        with the next sample. Nothing is allocated and the maths is all
+        FastMath, so this can be done on the audio thread as often as the
+        parameters move.
+    */
+    void setSettings (const FilterSettings& settings, double sampleRate) noexcept;
+
+    /** True if process() currently has nothing to do. */
+    bool isNeutral() const noexcept     { return numActive == 0; }
+
+    /** Filters the first numChannels channels of the buffer in place. */
+    void process (juce::AudioBuffer<SampleType>& buffer, int numChannels) noexcept;
+
+    /** Filters the first numChannels channels of the block in place. */
+    void process (const juce::dsp::AudioBlock<SampleType>& block, int numChannels) noexcept;
+
+private:
+    //==============================================================================
+    /** One slot: its settings now, where it's gliding to and the step it
+        takes each sample. The cutoff is prewarped, pi * fc / fs, and the
+        output is mix0 * input + mix1 * band-pass + mix2 * low-pass.
+    */
+    struct Stage
+    {
+        enum { cutoff, damping, mix0, mix1, mix2, numValues };
+
+        std::array<SampleType, numValues> value {}, target {}, step {};
+        int glideRemaining = 0;
+        bool active = false;
+    };
+
+    void setTarget (int index, SampleType cutoff, SampleType damping,
+                    SampleType mix0, SampleType mix1, SampleType mix2) noexcept;
+    void finishGlide (int index) noexcept;
+    void updateActiveStages() noexcept;
+    void fillCoefficients (const Stage& stage, SampleType* a1, SampleType* a2, SampleType* a3, int numSamples) noexcept;
+    void run (int numActiveGroups, int numSamples) noexcept;
+
+    static bool isPassThrough (const std::array<SampleType, Stage::numValues>& values) noexcept
+    {
+        return values[Stage::mix0] == 1 && values[Stage::mix1] == 0 && values[Stage::mix2] == 0;
+    }
+
+    std::array<Stage, numStages> stages;
+    int activeStages[numStages] {};
+    int numActive = 0, glideLength = 0;
+    bool hasSettings = false;
+
+    juce::HeapBlock<char> memory;
+    SIMDType* interleaved = nullptr;    // [numGroups][chunkSize]
+    SIMDType* state = nullptr;          // [numGroups][numStages][2]
+    SampleType* coefficients = nullptr; // [numStages][3][chunkSize], a1, a2 and a3 for each sample
+    int numGroups = 0, maxNumChannels = 0, lastNumChannels = 0;
+
+    //==============================================================================
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (SvfCascade)
+};
@@ -0,0 +1,74 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    Wait-free single-producer / single-consumer hand-over of plain data.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//==============================================================================
+/**
+    Hands the latest value of a trivially copyable type from one writer thread
+    to one reader thread.
+
+    Each side owns one of the three slots and the third sits in the middle. The
+    writer fills its slot and swaps it into the middle; the reader swaps its slot
+    for the middle one when there is something new. Both operations are a single
+    atomic exchange, so neither side can ever block or be blocked, and nothing is
+    allocated after construction.
+
+    Intermediate values may be skipped if the writer publishes faster than the
+    reader pulls - the reader always gets the most recent one.
+*/
+template <typename Type>
+class TripleBuffer
+{
+public:
+    static_assert (std::is_trivially_copyable<Type>::value,
+                   "The audio thread must be able to read this without running any constructors");
+
+    //==============================================================================
+    TripleBuffer() = default;
+
+    /** Writer side: the slot to fill before calling publish(). */
+    Type& getWriteBuffer() noexcept                 { return buffers[(size_t) writeIndex]; }
+
+    /** Writer side: makes the contents of the write slot visible to the reader. */
+    void publish() noexcept
+    {
+        writeIndex = state.exchange (writeIndex | newDataFlag, std::memory_order_acq_rel) & indexMask;
+    }
+
+    //==============================================================================
+    /** Reader side: swaps in the most recently published value, if there is one.
+        Returns true if getReadBuffer() now refers to new data.
+    */
+    bool pull() noexcept
+    {
+        if ((state.load (std::memory_order_relaxed) & newDataFlag) == 0)
+            return false;
+
+        readIndex = state.exchange (readIndex, std::memory_order_acq_rel) & indexMask;
+        return true;
+    }
+
+    /** Reader side: the value that was current at the last successful pull(). */
+    const Type& getReadBuffer() const noexcept      { return buffers[(size_t) readIndex]; }
+
+private:
+    //==============================================================================
+    static constexpr int indexMask = 3, newDataFlag = 4;
+
+    std::array<Type, 3> buffers {};
+    std::atomic<int> state { 1 };
+    int writeIndex = 0, readIndex = 2;
+
+    static_assert (std::atomic<int>::is_always_lock_free, "The hand-over must not fall back to a lock");
+
+    JUCE_DECLARE_NON_COPYABLE (TripleBuffer)
+};
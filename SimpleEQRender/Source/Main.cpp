@@ -0,0 +1,411 @@
+/*
+  ==============================================================================
+
+    Headless offline renderer for SimpleEQ.
+
+    Runs audio files through SimpleEQAudioProcessor without creating an editor,
+    spreading the files across every core with one processor per worker.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../SimpleEQ/Source/PluginProcessor.h"
+
+//==============================================================================
+struct RenderSettings
+{
+    juce::File outputFolder;
+    juce::MemoryBlock state;
+    juce::StringArray parameterOverrides;   // "ID=value"
+    int blockSize = 512;
+    bool useCoefficientTable = true;
+};
+
+struct RenderResult
+{
+    juce::File input, output;
+    juce::String error;
+    double audioSeconds = 0.0, totalSeconds = 0.0, dspSeconds = 0.0;
+};
+
+static double secondsSince (juce::int64 startTicks)
+{
+    return juce::Time::highResolutionTicksToSeconds (juce::Time::getHighResolutionTicks() - startTicks);
+}
+
+//==============================================================================
+/** One worker's processor, plus what it needs to get audio in and out of it. */
+class Renderer
+{
+public:
+    explicit Renderer (const RenderSettings& s)
+        : settings (s)
+    {
+        formats.registerBasicFormats();
+
+        processor.setNonRealtime (true);
+        processor.setUseCoefficientTable (settings.useCoefficientTable);
+
+        if (! settings.state.isEmpty())
+            processor.setStateInformation (settings.state.getData(), (int) settings.state.getSize());
+
+        for (auto& assignment : settings.parameterOverrides)
+            applyOverride (assignment.upToFirstOccurrenceOf ("=", false, false).trim(),
+                           assignment.fromFirstOccurrenceOf ("=", false, false).trim());
+    }
+
+    /** Non-empty if the state or a parameter override couldn't be applied. */
+    const juce::String& getSetupError() const noexcept     { return setupError; }
+
+    RenderResult render (const juce::File& input)
+    {
+        RenderResult result;
+        result.input = input;
+
+        if (setupError.isNotEmpty())
+            return failed (result, setupError);
+
+        auto startTicks = juce::Time::getHighResolutionTicks();
+        auto* format = formats.findFormatForFileExtension (input.getFileExtension());
+
+        if (format == nullptr)
+            return failed (result, "unsupported file type");
+
+        auto reader = createReader (*format, input);
+
+        if (reader == nullptr)
+            return failed (result, "couldn't read the file");
+
+        auto numChannels = (int) reader->numChannels;
+
+        if (! prepare (reader->sampleRate, numChannels))
+            return failed (result, "SimpleEQ doesn't support " + juce::String (numChannels) + " channels");
+
+        result.output = getOutputFileFor (input);
+        result.output.deleteFile();
+
+        std::unique_ptr<juce::OutputStream> stream (result.output.createOutputStream());
+        std::unique_ptr<juce::AudioFormatWriter> writer;
+
+        if (stream != nullptr)
+            writer.reset (format->createWriterFor (stream.get(), reader->sampleRate, (unsigned int) numChannels,
+                                                   (int) reader->bitsPerSample, reader->metadataValues, 0));
+
+        if (writer == nullptr)
+            return failed (result, "couldn't create " + result.output.getFullPathName());
+
+        stream.release(); // now owned by the writer
+
+        juce::AudioBuffer<float> buffer (numChannels, settings.blockSize);
+        juce::MidiBuffer midi;
+
+        // The processor's output lags its input by its latency, which the
+        // linear-phase LowCut and the oversamplers make thousands of samples
+        // long. A host would compensate for it, so the renderer does too: the
+        // first latency samples out are dropped, and the file is followed by
+        // enough silence to flush the delayed end and the tail out.
+        auto latency = (juce::int64) processor.getLatencySamples();
+        auto tail = (juce::int64) std::ceil (processor.getTailLengthSeconds() * reader->sampleRate);
+        auto totalLength = reader->lengthInSamples + latency + tail;
+
+        for (juce::int64 pos = 0; pos < totalLength; pos += settings.blockSize)
+        {
+            auto numSamples = (int) juce::jmin ((juce::int64) settings.blockSize, totalLength - pos);
+            buffer.setSize (numChannels, numSamples, false, false, true);
+
+            // Anything past the end of the file is read as silence.
+            reader->read (&buffer, 0, numSamples, pos, true, true);
+
+            auto dspStart = juce::Time::getHighResolutionTicks();
+            processor.processBlock (buffer, midi);
+            result.dspSeconds += secondsSince (dspStart);
+
+            auto numToSkip = (int) juce::jlimit ((juce::int64) 0, (juce::int64) numSamples, latency - pos);
+
+            if (numToSkip < numSamples
+                 && ! writer->writeFromAudioSampleBuffer (buffer, numToSkip, numSamples - numToSkip))
+                return failed (result, "write error");
+        }
+
+        writer.reset();
+
+        result.audioSeconds = (double) reader->lengthInSamples / reader->sampleRate;
+        result.totalSeconds = secondsSince (startTicks);
+        return result;
+    }
+
+private:
+    //==============================================================================
+    static RenderResult failed (RenderResult& result, const juce::String& message)
+    {
+        result.error = message;
+        return result;
+    }
+
+    void applyOverride (const juce::String& paramID, const juce::String& text)
+    {
+        auto* param = processor.apvts.getParameter (paramID);
+
+        if (param == nullptr)
+        {
+            setupError = "unknown parameter \"" + paramID + "\"";
+            return;
+        }
+
+        // Numbers are taken as plain values (or choice indices), anything else
+        // as the parameter's own text, e.g. "24 db/Oct".
+        auto normalised = text.containsOnly ("0123456789.-") ? param->convertTo0to1 (text.getFloatValue())
+                                                             : param->getValueForText (text);
+
+        param->setValueNotifyingHost (normalised);
+    }
+
+    std::unique_ptr<juce::AudioFormatReader> createReader (juce::AudioFormat& format, const juce::File& file)
+    {
+        // Map the whole file so that reading a block is a memcpy out of the page cache.
+        std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped (format.createMemoryMappedReader (file));
+
+        if (mapped != nullptr && mapped->mapEntireFile())
+            return mapped;
+
+        if (auto stream = file.createInputStream())
+            return std::unique_ptr<juce::AudioFormatReader> (format.createReaderFor (stream.release(), true));
+
+        return {};
+    }
+
+    bool prepare (double sampleRate, int numChannels)
+    {
+        // Each file starts from silence, whatever this worker rendered before it.
+        if (juce::approximatelyEqual (sampleRate, preparedSampleRate) && numChannels == preparedNumChannels)
+        {
+            processor.reset();
+            return true;
+        }
+
+        processor.releaseResources();
+
+        auto channels = juce::AudioChannelSet::canonicalChannelSet (numChannels);
+
+        juce::AudioProcessor::BusesLayout layout;
+        layout.inputBuses.add (channels);
+        layout.outputBuses.add (channels);
+
+        if (! processor.setBusesLayout (layout))
+            return false;
+
+        processor.setRateAndBufferSizeDetails (sampleRate, settings.blockSize);
+        processor.prepareToPlay (sampleRate, settings.blockSize);
+
+        preparedSampleRate  = sampleRate;
+        preparedNumChannels = numChannels;
+        return true;
+    }
+
+    juce::File getOutputFileFor (const juce::File& input) const
+    {
+        auto folder = settings.outputFolder == juce::File() ? input.getParentDirectory() : settings.outputFolder;
+        auto name = input.getFileName();
+
+        if (folder == input.getParentDirectory())
+            name = input.getFileNameWithoutExtension() + "_eq" + input.getFileExtension();
+
+        return folder.getChildFile (name);
+    }
+
+    //==============================================================================
+    const RenderSettings& settings;
+    juce::AudioFormatManager formats;
+    SimpleEQAudioProcessor processor;
+    juce::String setupError;
+    double preparedSampleRate = 0.0;
+    int preparedNumChannels = 0;
+
+    JUCE_DECLARE_NON_COPYABLE (Renderer)
+};
+
+//==============================================================================
+/** Pulls files off a shared list until there are none left. */
+class RenderJob  : public juce::ThreadPoolJob
+{
+public:
+    RenderJob (const RenderSettings& s, const juce::Array<juce::File>& f,
+               juce::Array<RenderResult>& r, std::atomic<int>& n, juce::CriticalSection& l)
+        : juce::ThreadPoolJob ("SimpleEQ render"), settings (s), files (f), results (r), nextFile (n), printLock (l)
+    {
+    }
+
+    JobStatus runJob() override
+    {
+        Renderer renderer (settings);
+
+        for (;;)
+        {
+            auto index = nextFile++;
+
+            if (index >= files.size() || shouldExit())
+                break;
+
+            auto result = renderer.render (files.getReference (index));
+            results.getReference (index) = result;
+
+            const juce::ScopedLock sl (printLock);
+            std::cout << describe (result) << std::endl;
+        }
+
+        return jobHasFinished;
+    }
+
+    static juce::String describe (const RenderResult& r)
+    {
+        if (r.error.isNotEmpty())
+            return r.input.getFileName() + ": FAILED - " + r.error;
+
+        return r.input.getFileName() + ": " + juce::String (r.audioSeconds, 2) + " s rendered in "
+                 + juce::String (r.totalSeconds, 3) + " s, "
+                 + juce::String (r.audioSeconds / r.totalSeconds, 1) + "x realtime (DSP only "
+                 + juce::String (r.audioSeconds / r.dspSeconds, 1) + "x) -> " + r.output.getFileName();
+    }
+
+private:
+    const RenderSettings& settings;
+    const juce::Array<juce::File>& files;
+    juce::Array<RenderResult>& results;
+    std::atomic<int>& nextFile;
+    juce::CriticalSection& printLock;
+
+    JUCE_DECLARE_NON_COPYABLE (RenderJob)
+};
+
+//==============================================================================
+static juce::Array<juce::File> findInputFiles (const juce::ArgumentList& args)
+{
+    juce::Array<juce::File> files;
+
+    for (auto& arg : args.arguments)
+    {
+        if (arg.isOption())
+            continue;
+
+        auto file = arg.resolveAsExistingFile();
+
+        if (file.isDirectory())
+            files.addArray (file.findChildFiles (juce::File::findFiles, false, "*.wav;*.aif;*.aiff"));
+        else
+            files.add (file);
+    }
+
+    if (files.isEmpty())
+        juce::ConsoleApplication::fail ("No input files given");
+
+    return files;
+}
+
+static RenderSettings parseSettings (const juce::ArgumentList& args)
+{
+    RenderSettings settings;
+
+    if (args.containsOption ("--out"))
+    {
+        settings.outputFolder = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--out"));
+
+        if (! settings.outputFolder.createDirectory())
+            juce::ConsoleApplication::fail ("Couldn't create " + settings.outputFolder.getFullPathName());
+    }
+
+    if (args.containsOption ("--state"))
+    {
+        auto stateFile = juce::File::getCurrentWorkingDirectory().getChildFile (args.getValueForOption ("--state"));
+
+        if (! stateFile.loadFileAsData (settings.state))
+            juce::ConsoleApplication::fail ("Couldn't read " + stateFile.getFullPathName());
+    }
+
+    for (auto& arg : args.arguments)
+        if (arg.isLongOption ("--set"))
+            settings.parameterOverrides.add (arg.getLongOptionValue());
+
+    if (args.containsOption ("--block"))
+        settings.blockSize = juce::jlimit (1, 65536, args.getValueForOption ("--block").getIntValue());
+
+    settings.useCoefficientTable = ! args.containsOption ("--no-table");
+    return settings;
+}
+
+static void render (const juce::ArgumentList& args)
+{
+    auto files = findInputFiles (args);
+    auto settings = parseSettings (args);
+
+    // Catch bad overrides up front rather than once per file.
+    {
+        Renderer probe (settings);
+
+        if (probe.getSetupError().isNotEmpty())
+            juce::ConsoleApplication::fail ("Error: " + probe.getSetupError());
+    }
+
+    auto numWorkers = args.containsOption ("--threads") ? args.getValueForOption ("--threads").getIntValue()
+                                                        : juce::SystemStats::getNumCpus();
+    numWorkers = juce::jlimit (1, files.size(), numWorkers);
+
+    juce::Array<RenderResult> results;
+    results.resize (files.size());
+
+    std::atomic<int> nextFile { 0 };
+    juce::CriticalSection printLock;
+    juce::OwnedArray<RenderJob> jobs;
+    juce::ThreadPool pool (numWorkers);
+
+    auto startTicks = juce::Time::getHighResolutionTicks();
+
+    for (int i = 0; i < numWorkers; ++i)
+        pool.addJob (jobs.add (new RenderJob (settings, files, results, nextFile, printLock)), false);
+
+    for (auto* job : jobs)
+        pool.waitForJobToFinish (job, -1);
+
+    auto wallSeconds = secondsSince (startTicks);
+    double audioSeconds = 0.0;
+    int numFailed = 0;
+
+    for (auto& r : results)
+    {
+        audioSeconds += r.audioSeconds;
+        numFailed += r.error.isNotEmpty() ? 1 : 0;
+    }
+
+    std::cout << files.size() << " files, " << numWorkers << " workers: " << juce::String (audioSeconds, 1)
+              << " s of audio in " << juce::String (wallSeconds, 2) << " s ("
+              << juce::String (audioSeconds / wallSeconds, 1) << "x realtime overall)" << std::endl;
+
+    if (numFailed > 0)
+        juce::ConsoleApplication::fail (juce::String (numFailed) + " file(s) failed");
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+    juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+    juce::ConsoleApplication app;
+
+    app.addHelpCommand ("--help|-h", "SimpleEQRender - offline SimpleEQ renderer", false);
+
+    app.addDefaultCommand ({ "",
+                             "[options] <files or folders...>",
+                             "Renders WAV/AIFF files through SimpleEQ",
+                             "Each output lines up sample for sample with its input, with SimpleEQ's latency\n"
+                             "taken out, and runs on for the length of the filters' tail.\n"
+                             "Options:\n"
+                             "  --out=<folder>      where to write the results (default: next to each input, with an _eq suffix)\n"
+                             "  --state=<file>      a state blob saved from the plugin, applied before any --set\n"
+                             "  --set=<ID>=<value>  sets a parameter, e.g. --set=\"LowCut Freq=80\" (may be repeated)\n"
+                             "  --block=<samples>   processBlock size (default 512)\n"
+                             "  --threads=<n>       number of worker threads (default: one per core)\n"
+                             "  --no-table          design coefficients directly instead of using the lookup table\n",
+                             render });
+
+    return app.findAndRunCommand (argc, argv);
+}